@@ -0,0 +1,435 @@
+#ifndef CONTROLLER_CORE_H
+#define CONTROLLER_CORE_H
+
+/*
+ * Controller core shared by all nexusHome device firmwares
+ * --------------------------------------------------------
+ *
+ * Header-only building blocks for relays, filtered inputs and timeouts.
+ * Every pin, pulse width, filter and timeout is a template parameter, so
+ * each device is described as a set of type instantiations and all timing
+ * arithmetic is resolved by the compiler (no runtime configuration).
+ *
+ * Only C++11 is required so the same header builds for AVR (UNO) and
+ * Renesas (UNO R4 WiFi) boards.
+ */
+
+#include <Arduino.h>
+
+namespace core {
+
+// ============================================================================
+// COMPILE-TIME TIMING HELPERS
+// ============================================================================
+
+constexpr unsigned long secondsToMs(unsigned long seconds) {
+  return seconds * 1000UL;
+}
+
+constexpr unsigned long samplesToMs(unsigned long samples, unsigned long sampleMs) {
+  return samples * sampleMs;
+}
+
+// millis() wraps at 2^32 on every board. Time differences are taken in 32
+// bits explicitly so the wrap-safe math also holds where long is 64-bit
+inline uint32_t sinceMs(unsigned long now, unsigned long startMs) {
+  return (uint32_t)(now - startMs);
+}
+
+// Wrap-safe check for millis() deadlines
+inline bool elapsed(unsigned long now, unsigned long startMs, unsigned long durationMs) {
+  return sinceMs(now, startMs) >= durationMs;
+}
+
+// ============================================================================
+// OUTPUTS
+// ============================================================================
+
+/**
+ * Digital output held at an on/off level (light relay, status LED)
+ * @tparam Pin Output pin
+ * @tparam ActiveHigh true if HIGH means "on"
+ */
+template <int Pin, bool ActiveHigh = true>
+class Output {
+ public:
+  static constexpr int pin = Pin;
+
+  void begin() {
+    pinMode(Pin, OUTPUT);
+    write(false);
+  }
+
+  void write(bool on) {
+    digitalWrite(Pin, (on == ActiveHigh) ? HIGH : LOW);
+    on_ = on;
+  }
+
+  bool isOn() const { return on_; }
+
+ private:
+  bool on_ = false;
+};
+
+/**
+ * Relay driven with a fixed-width pulse (door opener, power/input buttons)
+ * @tparam Pin Relay pin
+ * @tparam PulseMs Pulse width in milliseconds
+ */
+template <int Pin, unsigned long PulseMs, bool ActiveHigh = true>
+class PulseRelay {
+ public:
+  static constexpr int pin = Pin;
+  static constexpr unsigned long pulseMs = PulseMs;
+
+  void begin() { out_.begin(); }
+
+  // Non-blocking pulse: start it here and let update() release the relay
+  void trigger(unsigned long now) {
+    out_.write(true);
+    startMs_ = now;
+  }
+
+  // Returns true on the pass that ends the pulse
+  bool update(unsigned long now) {
+    if (!out_.isOn() || !elapsed(now, startMs_, PulseMs)) return false;
+    out_.write(false);
+    return true;
+  }
+
+  // Blocking pulse for controllers without a cooperative loop
+  void pulseBlocking() {
+    out_.write(true);
+    delay(PulseMs);
+    out_.write(false);
+  }
+
+  bool isActive() const { return out_.isOn(); }
+
+ private:
+  Output<Pin, ActiveHigh> out_;
+  unsigned long startMs_ = 0;
+};
+
+/**
+ * Output that switches itself off after a timeout
+ * @tparam Pin Output pin
+ * @tparam DefaultMs Timeout used when on() is called without a duration
+ */
+template <int Pin, unsigned long DefaultMs, bool ActiveHigh = true>
+class TimedOutput {
+ public:
+  static constexpr int pin = Pin;
+  static constexpr unsigned long defaultMs = DefaultMs;
+
+  void begin() { out_.begin(); }
+
+  void on(unsigned long now, unsigned long durationMs = DefaultMs) {
+    out_.write(true);
+    startMs_ = now;
+    durationMs_ = durationMs;
+  }
+
+  void off() { out_.write(false); }
+
+  // Returns true on the pass that switches the output off by timeout
+  bool update(unsigned long now) {
+    if (!out_.isOn() || !elapsed(now, startMs_, durationMs_)) return false;
+    out_.write(false);
+    return true;
+  }
+
+  unsigned long remainingMs(unsigned long now) const {
+    if (!out_.isOn()) return 0;
+    unsigned long el = sinceMs(now, startMs_);
+    return (el >= durationMs_) ? 0 : (durationMs_ - el);
+  }
+
+  bool isOn() const { return out_.isOn(); }
+
+ private:
+  Output<Pin, ActiveHigh> out_;
+  unsigned long startMs_ = 0;
+  unsigned long durationMs_ = DefaultMs;
+};
+
+// ============================================================================
+// INPUTS
+// ============================================================================
+
+/**
+ * Plain digital level (e.g. LDR module with built-in comparator)
+ * @tparam Pin Input pin
+ * @tparam ActiveHigh true if HIGH means "active"
+ */
+template <int Pin, bool ActiveHigh = true>
+class LevelInput {
+ public:
+  static constexpr int pin = Pin;
+
+  void begin() { pinMode(Pin, INPUT); }
+
+  bool read() const {
+    int v = digitalRead(Pin);
+    return ActiveHigh ? (v == HIGH) : (v == LOW);
+  }
+};
+
+/**
+ * Digital input that must read active twice in a row to count
+ * Filters out noise and floating pin states
+ * @tparam Pin Input pin
+ * @tparam ConfirmUs Delay between both reads in microseconds
+ */
+template <int Pin, unsigned int ConfirmUs, bool ActiveHigh = true>
+class ConfirmedInput {
+ public:
+  static constexpr int pin = Pin;
+  static constexpr unsigned int confirmUs = ConfirmUs;
+
+  void begin() { level_.begin(); }
+
+  bool read() const {
+    bool read1 = level_.read();
+    delayMicroseconds(ConfirmUs);
+    bool read2 = level_.read();
+    return read1 && read2;
+  }
+
+ private:
+  LevelInput<Pin, ActiveHigh> level_;
+};
+
+/**
+ * Push button with debounce, latch until release and refractory period
+ * Reports exactly one event per press
+ * @tparam Pin Button pin
+ * @tparam DebounceMs Delay before the confirmation read
+ * @tparam RefractoryMs Minimum time between press/release events
+ */
+template <int Pin, unsigned long DebounceMs, unsigned long RefractoryMs, bool ActiveHigh = true>
+class LatchedButton {
+ public:
+  static constexpr int pin = Pin;
+  static constexpr unsigned long debounceMs = DebounceMs;
+  static constexpr unsigned long refractoryMs = RefractoryMs;
+
+  void begin() { level_.begin(); }
+
+  bool justPressed(unsigned long now) {
+    if (!elapsed(now, lastEventMs_, RefractoryMs)) return false;
+
+    if (!latched_) {
+      // Waiting for press: check level, debounce, then latch
+      if (level_.read()) {
+        delay(DebounceMs);
+        if (level_.read()) {
+          latched_ = true;
+          lastEventMs_ = now;
+          return true;
+        }
+      }
+    } else if (!level_.read()) {
+      // Latched: wait for release to reset
+      latched_ = false;
+      lastEventMs_ = now;
+    }
+    return false;
+  }
+
+  bool isLatched() const { return latched_; }
+
+ private:
+  LevelInput<Pin, ActiveHigh> level_;
+  bool latched_ = false;
+  unsigned long lastEventMs_ = 0;
+};
+
+/**
+ * Analog signal detector with sample-count confirmation and loss window
+ * @tparam Pin Analog pin
+ * @tparam Threshold Minimum ADC value considered as signal
+ * @tparam ConfirmSamples Consecutive samples needed to confirm a signal
+ * @tparam LossSamples Samples without signal before it counts as lost
+ * @tparam SampleMs Delay between samples in milliseconds
+ */
+template <int Pin, int Threshold, unsigned int ConfirmSamples, unsigned int LossSamples, unsigned long SampleMs>
+class AnalogSignal {
+ public:
+  static constexpr int pin = Pin;
+  static constexpr int threshold = Threshold;
+  static constexpr unsigned long confirmMs = samplesToMs(ConfirmSamples, SampleMs);
+  static constexpr unsigned long lossMs = samplesToMs(LossSamples, SampleMs);
+
+  int level() const { return analogRead(Pin); }
+
+  bool present() const { return level() >= Threshold; }
+
+  // Blocks for confirmMs; true only if every sample was above threshold
+  bool confirm() const {
+    unsigned int validSamples = 0;
+    for (unsigned int i = 0; i < ConfirmSamples; i++) {
+      if (present()) {
+        validSamples++;
+      } else {
+        validSamples = 0;
+      }
+      delay(SampleMs);
+    }
+    return validSamples >= ConfirmSamples;
+  }
+
+  // Returns false as soon as the signal is seen, true once lossMs pass without it
+  bool lost() const {
+    unsigned int noSignalCount = 0;
+    for (unsigned int i = 0; i < LossSamples; i++) {
+      if (!present()) {
+        noSignalCount++;
+      } else {
+        noSignalCount = 0;
+      }
+      delay(SampleMs);
+      if (noSignalCount == 0) return false;
+    }
+    return true;
+  }
+};
+
+/**
+ * Reports level changes once the new level has held for a settle time
+ * Filters sensor chatter (e.g. LDR around dusk) before acting on transitions
+ * @tparam SettleMs Time a new level must hold before it counts
+ */
+template <unsigned long SettleMs>
+class EdgeDetector {
+ public:
+  static constexpr unsigned long settleMs = SettleMs;
+
+  // Returns true on the pass where a settled transition is detected;
+  // the first call only latches the initial level
+  bool update(bool level, unsigned long now) {
+    if (!initialized_) {
+      initialized_ = true;
+      state_ = candidate_ = level;
+      return false;
+    }
+    if (level != candidate_) {
+      candidate_ = level;
+      sinceMs_ = now;
+    }
+    if (candidate_ == state_ || !elapsed(now, sinceMs_, SettleMs)) return false;
+    state_ = candidate_;
+    return true;
+  }
+
+  bool state() const { return state_; }
+
+ private:
+  bool initialized_ = false;
+  bool state_ = false;
+  bool candidate_ = false;
+  unsigned long sinceMs_ = 0;
+};
+
+// ============================================================================
+// TIMERS
+// ============================================================================
+
+/**
+ * Fixed-capacity min-heap of timed items ordered by millis() deadline
+ * Checking for due work only looks at the head, so it costs O(1) per loop
+ * pass however many items are queued. Deadlines must lie within ~24 days
+ * of each other for the wrap-safe ordering to hold.
+ * @tparam T Item type with an `unsigned long deadline` member
+ * @tparam Capacity Maximum number of queued items
+ */
+template <class T, uint8_t Capacity>
+class DeadlineQueue {
+  static_assert(Capacity > 0, "DeadlineQueue needs room for at least one item");
+
+ public:
+  static constexpr uint8_t capacity = Capacity;
+
+  bool empty() const { return size_ == 0; }
+  uint8_t size() const { return size_; }
+  void clear() { size_ = 0; }
+
+  // Earliest item; only valid when not empty
+  const T& top() const { return items_[0]; }
+
+  bool due(unsigned long now) const {
+    return size_ > 0 && (int32_t)sinceMs(now, items_[0].deadline) >= 0;
+  }
+
+  // Returns false (and drops the item) when the queue is full
+  bool push(const T& item) {
+    if (size_ >= Capacity) return false;
+    uint8_t i = size_++;
+    items_[i] = item;
+    siftUp(i);
+    return true;
+  }
+
+  void pop() {
+    if (size_ == 0) return;
+    items_[0] = items_[--size_];
+    siftDown(0);
+  }
+
+  // Removes every item matching pred, O(n); meant for rare cancellations
+  template <class Pred>
+  void removeIf(Pred pred) {
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < size_; i++) {
+      if (!pred(items_[i])) items_[kept++] = items_[i];
+    }
+    size_ = kept;
+    for (int i = (int)size_ / 2 - 1; i >= 0; i--) siftDown((uint8_t)i);
+  }
+
+  // Edits every item in place; fn must not change the deadline
+  template <class Fn>
+  void forEach(Fn fn) {
+    for (uint8_t i = 0; i < size_; i++) fn(items_[i]);
+  }
+
+ private:
+  T items_[Capacity];
+  uint8_t size_ = 0;
+
+  static bool before(const T& a, const T& b) {
+    return (int32_t)sinceMs(a.deadline, b.deadline) < 0;
+  }
+
+  void swap(uint8_t a, uint8_t b) {
+    T tmp = items_[a];
+    items_[a] = items_[b];
+    items_[b] = tmp;
+  }
+
+  void siftUp(uint8_t i) {
+    while (i > 0) {
+      uint8_t parent = (i - 1) / 2;
+      if (!before(items_[i], items_[parent])) return;
+      swap(i, parent);
+      i = parent;
+    }
+  }
+
+  void siftDown(uint8_t i) {
+    while (true) {
+      unsigned int left = 2u * i + 1;
+      unsigned int right = left + 1;
+      uint8_t first = i;
+      if (left < size_ && before(items_[left], items_[first])) first = (uint8_t)left;
+      if (right < size_ && before(items_[right], items_[first])) first = (uint8_t)right;
+      if (first == i) return;
+      swap(i, first);
+      i = first;
+    }
+  }
+};
+
+}  // namespace core
+
+#endif
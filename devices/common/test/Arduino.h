@@ -0,0 +1,105 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+/*
+ * Host stand-in for the Arduino core used by the unit tests
+ * ---------------------------------------------------------
+ *
+ * Time only moves through delay() or fake::advance() and millis() wraps at
+ * 2^32 as on the boards. Outputs are recorded with the millis() at which
+ * they were written, and inputs are levels or scripted read sequences set
+ * by the test. Just enough API for the device headers under test.
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define HIGH 1
+#define LOW  0
+#define LED_BUILTIN 13
+
+// Analog pin numbers as on the UNO
+static const uint8_t A4 = 18;
+static const uint8_t A5 = 19;
+
+enum PinMode { INPUT, OUTPUT, INPUT_PULLUP };
+
+void pinMode(int pin, PinMode mode);
+void digitalWrite(int pin, int level);
+int digitalRead(int pin);
+int analogRead(int pin);
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+class String {
+ public:
+  String() {}
+  String(const char* s) : s_(s) {}
+  String(const std::string& s) : s_(s) {}
+  String(char c) : s_(1, c) {}
+  String(unsigned char v) : s_(std::to_string((unsigned)v)) {}
+  String(int v) : s_(std::to_string(v)) {}
+  String(unsigned int v) : s_(std::to_string(v)) {}
+  String(long v) : s_(std::to_string(v)) {}
+  String(unsigned long v) : s_(std::to_string(v)) {}
+
+  unsigned int length() const { return (unsigned int)s_.size(); }
+  const char* c_str() const { return s_.c_str(); }
+  char operator[](unsigned int i) const { return s_[i]; }
+
+  String& operator+=(const String& o) { s_ += o.s_; return *this; }
+  bool operator==(const char* o) const { return s_ == o; }
+  bool operator==(const String& o) const { return s_ == o.s_; }
+
+  friend String operator+(const String& a, const String& b) { return String(a.s_ + b.s_); }
+
+ private:
+  std::string s_;
+};
+
+class FakeSerial {
+ public:
+  void begin(long) {}
+  template <class T> void print(const T&) {}
+  template <class T> void print(const T&, int) {}
+  template <class T> void println(const T&) {}
+  void println() {}
+};
+
+extern FakeSerial Serial;
+
+namespace fake {
+
+const int PIN_COUNT = 32;
+
+struct PinWrite {
+  int pin;
+  int level;
+  unsigned long ms;
+};
+
+// Clears pins, scripts, write log and EEPROM, and sets the clock
+void reset(unsigned long nowMs = 0);
+void advance(unsigned long ms);
+
+// Digital input: reads come from the script first, then from the level
+void setLevel(int pin, int level);
+void scriptDigital(int pin, const std::vector<int>& reads);
+
+// Analog input: reads come from the script first, then from the value
+void setAnalog(int pin, int value);
+void scriptAnalog(int pin, const std::vector<int>& reads);
+unsigned int analogReadCount(int pin);
+
+int outputLevel(int pin);
+PinMode mode(int pin);
+unsigned int lastDelayUs();
+const std::vector<PinWrite>& writes();
+
+}  // namespace fake
+
+#endif
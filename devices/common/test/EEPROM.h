@@ -0,0 +1,35 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+// Host stand-in for the Arduino EEPROM library, erased by fake::reset()
+
+#include <stdint.h>
+#include <string.h>
+
+class FakeEEPROM {
+ public:
+  static const int SIZE = 1024;
+
+  uint8_t read(int addr) const { return data_[addr]; }
+  void write(int addr, uint8_t v) { data_[addr] = v; }
+  int length() const { return SIZE; }
+
+  template <class T> T& get(int addr, T& t) const {
+    memcpy(&t, data_ + addr, sizeof(T));
+    return t;
+  }
+
+  template <class T> const T& put(int addr, const T& t) {
+    memcpy(data_ + addr, &t, sizeof(T));
+    return t;
+  }
+
+  void erase() { memset(data_, 0xFF, sizeof(data_)); }
+
+ private:
+  uint8_t data_[SIZE];
+};
+
+extern FakeEEPROM EEPROM;
+
+#endif
@@ -0,0 +1,188 @@
+/*
+ * API benchmark statistics, baseline comparison and request guards
+ *
+ * Samples are added in schedule order, not sorted, as the benchmark
+ * aggregates them.
+ */
+
+#define API_BENCH_NO_MAIN
+#include "test.h"
+#include "../../garage-iot-controller/test/api_bench.cpp"
+
+static Sample sample(Outcome outcome, int status, double latencyMs) {
+  Sample s;
+  s.request = 0;
+  s.outcome = outcome;
+  s.status = status;
+  s.latencyMs = latencyMs;
+  return s;
+}
+
+// 1..n ms, visited in a stride order so the input is far from sorted
+static Stats strided(int n) {
+  Stats s;
+  for (int i = 0; i < n; i++) s.add(sample(OUTCOME_OK, 200, (double)((i * 7919) % n + 1)));
+  s.finalize();
+  return s;
+}
+
+static Json parseJson(const char* text) {
+  Json j;
+  CHECK(JsonParser(text).parse(j));
+  return j;
+}
+
+void testPercentilesAreNearestRank() {
+  Stats s = strided(1000);
+  CHECK_EQ(s.latencies.size(), 1000U);
+  CHECK_EQ(s.percentile(50), 500);
+  CHECK_EQ(s.percentile(99), 990);
+  CHECK_EQ(s.percentile(99.9), 999);
+  CHECK_EQ(s.percentile(100), 1000);
+  CHECK_EQ(s.percentile(0), 1);
+
+  Stats empty;
+  empty.finalize();
+  CHECK_EQ(empty.percentile(99), 0);
+}
+
+void testTimeoutsCountRefusalsDoNot() {
+  Stats s;
+  for (int i = 0; i < 97; i++) s.add(sample(OUTCOME_OK, 200, 2));
+  s.add(sample(OUTCOME_TIMEOUT, 0, 2000));
+  s.add(sample(OUTCOME_TIMEOUT, 0, 2001));
+  s.add(sample(OUTCOME_CONNECT_FAILED, 0, 1));
+  s.finalize();
+
+  CHECK_EQ(s.count, 100U);
+  CHECK_EQ(s.timeouts, 2U);
+  CHECK_EQ(s.connectFailures, 1U);
+  CHECK_EQ(s.latencies.size(), 99U);
+  CHECK_EQ(s.percentile(99), 2001);
+  CHECK(s.errorRate() > 0.0299 && s.errorRate() < 0.0301);
+}
+
+// 5% of responses at 200 ms, spread through the run
+void testSlowTailIsFlagged() {
+  Stats s;
+  for (int i = 0; i < 1000; i++) s.add(sample(OUTCOME_OK, 200, (i % 20 == 19) ? 200.0 : 3.0));
+  s.finalize();
+  CHECK_EQ(s.percentile(50), 3);
+  CHECK_EQ(s.percentile(99), 200);
+
+  Json base = parseJson("{\"error_rate\": 0, \"latency_ms\": {\"p50\": 3, \"p99\": 5, \"p999\": 5}}");
+  std::vector<Regression> out;
+  compareStats("overall", s, base, 20.0, 5.0, 1.0, out);
+  CHECK_EQ(out.size(), 2U);
+  if (out.size() == 2) {
+    CHECK(out[0].metric == "latency_ms.p99");
+    CHECK_EQ(out[0].current, 200);
+    CHECK(out[1].metric == "latency_ms.p999");
+  }
+}
+
+void testSameRunPassesBaseline() {
+  Stats s = strided(1000);
+  Json base = parseJson("{\"error_rate\": 0, \"latency_ms\": {\"p50\": 500, \"p99\": 990, \"p999\": 999}}");
+  std::vector<Regression> out;
+  compareStats("overall", s, base, 20.0, 5.0, 1.0, out);
+  CHECK(out.empty());
+}
+
+void testLatencyNeedsPercentAndDelta() {
+  Stats s;
+  for (int i = 0; i < 100; i++) s.add(sample(OUTCOME_OK, 200, 4));
+  s.finalize();
+
+  // +100% but only +2 ms
+  Json small = parseJson("{\"latency_ms\": {\"p50\": 2}}");
+  std::vector<Regression> out;
+  compareStats("overall", s, small, 20.0, 5.0, 1.0, out);
+  CHECK(out.empty());
+  compareStats("overall", s, small, 20.0, 1.0, 1.0, out);
+  CHECK_EQ(out.size(), 1U);
+}
+
+void testErrorToleranceIsPoints() {
+  Stats s;
+  for (int i = 0; i < 995; i++) s.add(sample(OUTCOME_OK, 200, 1));
+  for (int i = 0; i < 5; i++) s.add(sample(OUTCOME_HTTP_ERROR, 500, 1));
+  s.finalize();
+
+  Json base = parseJson("{\"error_rate\": 0}");
+  std::vector<Regression> out;
+  compareStats("overall", s, base, 20.0, 5.0, 1.0, out);
+  CHECK(out.empty());
+  compareStats("overall", s, base, 20.0, 5.0, 0.25, out);
+  CHECK_EQ(out.size(), 1U);
+  if (out.size() == 1) CHECK(out[0].metric == "error_rate");
+}
+
+void testWriteStatsReportsPercentiles() {
+  const Stats s = strided(1000);
+  std::ostringstream os;
+  writeStats(os, s, "");
+  Json j = parseJson(os.str().c_str());
+  const Json* lat = j.get("latency_ms");
+  CHECK(lat != nullptr);
+  if (!lat) return;
+  CHECK_EQ(lat->get("samples")->number, 1000);
+  CHECK_EQ(lat->get("p99")->number, 990);
+  CHECK_EQ(lat->get("max")->number, 1000);
+}
+
+static BenchRequest setRequest(const char* body) {
+  BenchRequest r;
+  r.name = "set";
+  r.method = "POST";
+  r.path = "/set";
+  r.body = body;
+  return r;
+}
+
+void testDoorGuardIgnoresCase() {
+  CHECK(targetsDoor(setRequest("{\"device\": \"door\", \"action\": \"open\"}")));
+  CHECK(targetsDoor(setRequest("{\"device\": \"Door\", \"action\": \"open\"}")));
+  CHECK(targetsDoor(setRequest("{\"device\": \"DOOR\", \"action\": \"close\"}")));
+  CHECK(!targetsDoor(setRequest("{\"device\": \"lamp\", \"action\": \"on\"}")));
+  CHECK(!targetsDoor(setRequest("")));
+}
+
+// The firmware still finds the keys in a body our parser rejects
+void testDoorGuardFailsSafeOnBadJson() {
+  CHECK(targetsDoor(setRequest("{\"device\": \"DOOR\", \"action\": \"open\",}")));
+  CHECK(!targetsDoor(setRequest("{\"device\": \"lamp\",}")));
+}
+
+void testRequestsKeepTheirOwnHost() {
+  Json items = parseJson(
+      "[{\"name\": \"a\", \"request\": {\"method\": \"GET\", \"url\": {\"raw\": \"{{base_url}}/status\"}}},"
+      " {\"name\": \"folder\", \"item\": ["
+      "  {\"name\": \"b\", \"request\": {\"method\": \"GET\", \"url\": \"http://10.0.0.2:8080/status\"}}]},"
+      " {\"name\": \"c\", \"request\": {\"method\": \"GET\", \"url\": {\"raw\": \"{{base_url}}\"}}}]");
+  std::map<std::string, std::string> vars;
+  vars["base_url"] = "http://192.168.1.190";
+  std::vector<BenchRequest> out;
+  collectRequests(items, vars, out);
+
+  CHECK_EQ(out.size(), 3U);
+  if (out.size() != 3) return;
+  CHECK(out[0].target.str() == "192.168.1.190");
+  CHECK(out[1].target.str() == "10.0.0.2:8080");
+  CHECK(out[2].target.str() == "192.168.1.190");
+  CHECK(out[2].path == "/");
+}
+
+int main() {
+  RUN_TEST(testPercentilesAreNearestRank, 0UL);
+  RUN_TEST(testTimeoutsCountRefusalsDoNot, 0UL);
+  RUN_TEST(testSlowTailIsFlagged, 0UL);
+  RUN_TEST(testSameRunPassesBaseline, 0UL);
+  RUN_TEST(testLatencyNeedsPercentAndDelta, 0UL);
+  RUN_TEST(testErrorToleranceIsPoints, 0UL);
+  RUN_TEST(testWriteStatsReportsPercentiles, 0UL);
+  RUN_TEST(testDoorGuardIgnoresCase, 0UL);
+  RUN_TEST(testDoorGuardFailsSafeOnBadJson, 0UL);
+  RUN_TEST(testRequestsKeepTheirOwnHost, 0UL);
+  return testSummary("bench_test");
+}
@@ -0,0 +1,219 @@
+/*
+ * controller_core timers and edge detection
+ *
+ * DeadlineQueue ordering is checked against a sorted reference, with
+ * deadlines that straddle the millis() wrap and the signed midpoint.
+ */
+
+#include <algorithm>
+
+#include "test.h"
+#include "controller_core.h"
+
+struct Item {
+  unsigned long deadline;
+  int id;
+};
+
+typedef core::DeadlineQueue<Item, 16> Queue;
+
+// Deadline as the boards compute it: 32-bit, wrapping past 0xFFFFFFFF
+static unsigned long at(unsigned long t0, unsigned long offsetMs) {
+  return (uint32_t)(t0 + offsetMs);
+}
+
+// Small deterministic LCG so failures reproduce
+static unsigned long rngState = 1;
+static unsigned long nextRandom() {
+  rngState = rngState * 1103515245UL + 12345UL;
+  return (rngState >> 8) & 0xFFFFUL;
+}
+
+void testQueuePopsInDeadlineOrder() {
+  Queue q;
+  unsigned long t0 = millis();
+  const unsigned long offsets[] = {50, 10, 30, 20, 40};
+  for (int i = 0; i < 5; i++) q.push({at(t0, offsets[i]), i});
+
+  CHECK_EQ(q.size(), 5U);
+  const int order[] = {1, 3, 2, 4, 0};
+  for (int i = 0; i < 5; i++) {
+    CHECK_EQ(q.top().id, order[i]);
+    q.pop();
+  }
+  CHECK(q.empty());
+  q.pop();  // Harmless when empty
+  CHECK(q.empty());
+}
+
+void testQueueOrdersAcrossWrap() {
+  Queue q;
+  unsigned long t0 = 0xFFFFFF00UL;
+  // After the wrap the raw value is small but the deadline is later
+  q.push({at(t0, 0x180), 1});  // 0x00000080
+  q.push({at(t0, 0x80), 0});   // 0xFFFFFF80
+
+  CHECK_EQ(q.top().id, 0);
+  CHECK(!q.due(at(t0, 0x7F)));
+  CHECK(q.due(at(t0, 0x80)));
+  q.pop();
+  CHECK_EQ(q.top().id, 1);
+  CHECK(!q.due(at(t0, 0xFF)));  // 0xFFFFFFFF is before 0x00000080
+  CHECK(!q.due(at(t0, 0x17F)));
+  CHECK(q.due(at(t0, 0x180)));
+  CHECK(q.due(at(t0, 0x1000)));
+}
+
+void testQueueDueOnlyWhenNotEmpty() {
+  Queue q;
+  unsigned long t0 = millis();
+  CHECK(!q.due(t0));
+  q.push({t0, 0});
+  CHECK(q.due(t0));
+  q.clear();
+  CHECK(q.empty());
+  CHECK(!q.due(t0));
+}
+
+void testQueueFullRejectsPush() {
+  core::DeadlineQueue<Item, 3> q;
+  unsigned long t0 = millis();
+  CHECK(q.push({at(t0, 3), 0}));
+  CHECK(q.push({at(t0, 2), 1}));
+  CHECK(q.push({at(t0, 1), 2}));
+  CHECK(!q.push({t0, 3}));
+  CHECK_EQ(q.size(), 3U);
+  CHECK_EQ(q.top().id, 2);
+}
+
+// Random pushes and pops against a reference sorted by time from t0
+void testQueueRandomizedAgainstReference() {
+  Queue q;
+  std::vector<unsigned long> ref;
+  unsigned long t0 = millis();
+  rngState = 1;
+
+  for (int step = 0; step < 5000; step++) {
+    bool push = ref.empty() || (ref.size() < Queue::capacity && nextRandom() % 3 != 0);
+    if (push) {
+      unsigned long d = at(t0, nextRandom() % 20000);
+      CHECK(q.push({d, step}));
+      ref.push_back(core::sinceMs(d, t0));
+      std::sort(ref.begin(), ref.end());
+    } else {
+      CHECK_EQ(q.top().deadline - t0, ref.front());
+      q.pop();
+      ref.erase(ref.begin());
+    }
+    CHECK_EQ(q.size(), ref.size());
+  }
+  while (!ref.empty()) {
+    CHECK_EQ(q.top().deadline - t0, ref.front());
+    q.pop();
+    ref.erase(ref.begin());
+  }
+  CHECK(q.empty());
+}
+
+void testQueueRemoveIfRestoresHeap() {
+  unsigned long t0 = millis();
+  rngState = 7;
+
+  for (int round = 0; round < 200; round++) {
+    Queue q;
+    std::vector<unsigned long> ref;
+    int n = 1 + (int)(nextRandom() % Queue::capacity);
+    for (int i = 0; i < n; i++) {
+      unsigned long d = at(t0, nextRandom() % 20000);
+      q.push({d, i});
+    }
+    int mod = 2 + (int)(nextRandom() % 3);
+    q.removeIf([mod](const Item& it) { return it.id % mod == 0; });
+
+    // Every survivor and nothing else, still in deadline order
+    unsigned long last = 0;
+    int popped = 0;
+    while (!q.empty()) {
+      CHECK(q.top().id % mod != 0);
+      CHECK(core::sinceMs(q.top().deadline, t0) >= last);
+      last = core::sinceMs(q.top().deadline, t0);
+      q.pop();
+      popped++;
+    }
+    CHECK_EQ(popped, n - (n + mod - 1) / mod);
+  }
+}
+
+void testQueueForEachEditsInPlace() {
+  Queue q;
+  unsigned long t0 = millis();
+  for (int i = 0; i < 6; i++) q.push({at(t0, (unsigned long)(6 - i) * 10), i});
+
+  q.forEach([](Item& it) { it.id += 100; });
+
+  for (int i = 5; i >= 0; i--) {
+    CHECK_EQ(q.top().id, 100 + i);
+    q.pop();
+  }
+}
+
+void testEdgeFirstUpdateOnlyLatches() {
+  core::EdgeDetector<500> edge;
+  unsigned long t0 = millis();
+  CHECK(!edge.update(true, t0));
+  CHECK(edge.state());
+  CHECK(!edge.update(true, t0 + 10000));
+}
+
+void testEdgeNeedsSettleTime() {
+  core::EdgeDetector<500> edge;
+  unsigned long t0 = millis();
+  edge.update(false, t0);
+
+  CHECK(!edge.update(true, t0 + 100));
+  CHECK(!edge.update(true, t0 + 599));
+  CHECK(!edge.state());
+  CHECK(edge.update(true, t0 + 600));
+  CHECK(edge.state());
+  // Reported once
+  CHECK(!edge.update(true, t0 + 700));
+}
+
+void testEdgeChatterRestartsSettle() {
+  core::EdgeDetector<500> edge;
+  unsigned long t0 = millis();
+  edge.update(false, t0);
+
+  edge.update(true, t0 + 100);
+  edge.update(false, t0 + 300);
+  CHECK(!edge.update(true, t0 + 400));
+  CHECK(!edge.update(true, t0 + 899));
+  CHECK(edge.update(true, t0 + 900));
+}
+
+void testEdgeBlipIsIgnored() {
+  core::EdgeDetector<500> edge;
+  unsigned long t0 = millis();
+  edge.update(false, t0);
+
+  edge.update(true, t0 + 100);
+  CHECK(!edge.update(false, t0 + 200));
+  CHECK(!edge.update(false, t0 + 5000));
+  CHECK(!edge.state());
+}
+
+int main() {
+  RUN_TEST_WRAP(testQueuePopsInDeadlineOrder);
+  RUN_TEST(testQueueOrdersAcrossWrap, 0UL);
+  RUN_TEST_WRAP(testQueueDueOnlyWhenNotEmpty);
+  RUN_TEST_WRAP(testQueueFullRejectsPush);
+  RUN_TEST_WRAP(testQueueRandomizedAgainstReference);
+  RUN_TEST(testQueueRandomizedAgainstReference, 0x7FFFF000UL);
+  RUN_TEST_WRAP(testQueueRemoveIfRestoresHeap);
+  RUN_TEST_WRAP(testQueueForEachEditsInPlace);
+  RUN_TEST(testEdgeFirstUpdateOnlyLatches, 0UL);
+  RUN_TEST_WRAP(testEdgeNeedsSettleTime);
+  RUN_TEST_WRAP(testEdgeChatterRestartsSettle);
+  RUN_TEST_WRAP(testEdgeBlipIsIgnored);
+  return testSummary("core_test");
+}
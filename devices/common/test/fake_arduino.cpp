@@ -0,0 +1,81 @@
+#include "Arduino.h"
+#include "EEPROM.h"
+
+#include <deque>
+
+FakeSerial Serial;
+FakeEEPROM EEPROM;
+
+namespace {
+
+uint32_t nowMs = 0;  // Wraps at 2^32 like the boards' millis()
+unsigned int lastUs = 0;
+int levels[fake::PIN_COUNT];
+int outputs[fake::PIN_COUNT];
+int analogValues[fake::PIN_COUNT];
+unsigned int analogReads[fake::PIN_COUNT];
+PinMode modes[fake::PIN_COUNT];
+std::deque<int> digitalScripts[fake::PIN_COUNT];
+std::deque<int> analogScripts[fake::PIN_COUNT];
+std::vector<fake::PinWrite> writeLog;
+
+int nextRead(std::deque<int>& script, int fallback) {
+  if (script.empty()) return fallback;
+  int v = script.front();
+  script.pop_front();
+  return v;
+}
+
+}  // namespace
+
+void pinMode(int pin, PinMode mode) { modes[pin] = mode; }
+
+void digitalWrite(int pin, int level) {
+  outputs[pin] = level;
+  writeLog.push_back({pin, level, nowMs});
+}
+
+int digitalRead(int pin) { return nextRead(digitalScripts[pin], levels[pin]); }
+
+int analogRead(int pin) {
+  analogReads[pin]++;
+  return nextRead(analogScripts[pin], analogValues[pin]);
+}
+
+unsigned long millis() { return nowMs; }
+void delay(unsigned long ms) { nowMs += ms; }
+void delayMicroseconds(unsigned int us) { lastUs = us; }
+
+namespace fake {
+
+void reset(unsigned long startMs) {
+  nowMs = startMs;
+  lastUs = 0;
+  for (int i = 0; i < PIN_COUNT; i++) {
+    levels[i] = LOW;
+    outputs[i] = LOW;
+    analogValues[i] = 0;
+    analogReads[i] = 0;
+    modes[i] = INPUT;
+    digitalScripts[i].clear();
+    analogScripts[i].clear();
+  }
+  writeLog.clear();
+  EEPROM.erase();
+}
+
+void advance(unsigned long ms) { nowMs += ms; }
+
+void setLevel(int pin, int level) { levels[pin] = level; }
+void scriptDigital(int pin, const std::vector<int>& reads) { digitalScripts[pin].assign(reads.begin(), reads.end()); }
+
+void setAnalog(int pin, int value) { analogValues[pin] = value; }
+void scriptAnalog(int pin, const std::vector<int>& reads) { analogScripts[pin].assign(reads.begin(), reads.end()); }
+unsigned int analogReadCount(int pin) { return analogReads[pin]; }
+
+int outputLevel(int pin) { return outputs[pin]; }
+PinMode mode(int pin) { return modes[pin]; }
+unsigned int lastDelayUs() { return lastUs; }
+const std::vector<PinWrite>& writes() { return writeLog; }
+
+}  // namespace fake
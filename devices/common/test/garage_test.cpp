@@ -0,0 +1,225 @@
+/*
+ * Garage IoT Controller configuration against the pre-template behaviour
+ *
+ * Expected values are the ones the original sketch hard-coded (400ms door
+ * pulse, 120s light, 10ms button debounce + 1200ms refractory, 10us door
+ * double read), not the constants from config.h.
+ */
+
+#include "test.h"
+#include "../../garage-iot-controller/src/config.h"
+
+void testBeginDrivesOutputsLow() {
+  LightRelay light;
+  DoorRelay door;
+  DebugLed led;
+  Button button;
+  DoorSensor doorSensor;
+  NightSensor nightSensor;
+  light.begin();
+  door.begin();
+  led.begin();
+  button.begin();
+  doorSensor.begin();
+  nightSensor.begin();
+
+  CHECK_EQ(fake::mode(2), OUTPUT);
+  CHECK_EQ(fake::mode(3), OUTPUT);
+  CHECK_EQ(fake::mode(13), OUTPUT);
+  CHECK_EQ(fake::outputLevel(2), LOW);
+  CHECK_EQ(fake::outputLevel(3), LOW);
+  CHECK_EQ(fake::outputLevel(13), LOW);
+  CHECK_EQ(fake::mode(9), INPUT);
+  CHECK_EQ(fake::mode(11), INPUT);
+  CHECK_EQ(fake::mode(12), INPUT);
+}
+
+void testDoorPulseLasts400ms() {
+  DoorRelay door;
+  door.begin();
+  unsigned long t0 = millis();
+
+  door.trigger(t0);
+  CHECK(door.isActive());
+  CHECK_EQ(fake::outputLevel(3), HIGH);
+
+  // Still before the wrap when started at 0xFFFFFF00
+  CHECK(!door.update(t0 + 1));
+  CHECK(!door.update(t0 + 399));
+  CHECK_EQ(fake::outputLevel(3), HIGH);
+
+  CHECK(door.update(t0 + 400));
+  CHECK(!door.isActive());
+  CHECK_EQ(fake::outputLevel(3), LOW);
+
+  // The pulse ends only once
+  CHECK(!door.update(t0 + 401));
+}
+
+void testLightDefaultTimeoutIs120s() {
+  LightRelay light;
+  light.begin();
+  unsigned long t0 = millis();
+
+  light.on(t0);
+  CHECK(light.isOn());
+  CHECK_EQ(fake::outputLevel(2), HIGH);
+  CHECK_EQ(light.remainingMs(t0), 120000UL);
+  CHECK_EQ(light.remainingMs(t0 + 119999), 1UL);
+
+  CHECK(!light.update(t0 + 1));
+  CHECK(!light.update(t0 + 119999));
+  CHECK(light.isOn());
+
+  CHECK(light.update(t0 + 120000));
+  CHECK(!light.isOn());
+  CHECK_EQ(fake::outputLevel(2), LOW);
+  CHECK_EQ(light.remainingMs(t0 + 120000), 0UL);
+}
+
+void testLightRequestedDurationAndRestart() {
+  LightRelay light;
+  light.begin();
+  unsigned long t0 = millis();
+
+  // API "duration": 30
+  light.on(t0, core::secondsToMs(30));
+  CHECK_EQ(light.remainingMs(t0 + 10000), 20000UL);
+
+  // A new request restarts the timeout from its own start time
+  light.on(t0 + 20000, core::secondsToMs(30));
+  CHECK(!light.update(t0 + 30000));
+  CHECK(!light.update(t0 + 49999));
+  CHECK(light.update(t0 + 50000));
+}
+
+// As loop() drives it: every call reads the (wrapping) millis()
+void testLightTimeoutFollowsMillis() {
+  LightRelay light;
+  light.begin();
+
+  light.on(millis());
+  fake::advance(60000);
+  CHECK_EQ(light.remainingMs(millis()), 60000UL);
+  CHECK(!light.update(millis()));
+  fake::advance(60000);
+  CHECK(light.update(millis()));
+  CHECK(!light.isOn());
+}
+
+void testLightOffCancelsTimeout() {
+  LightRelay light;
+  light.begin();
+  unsigned long t0 = millis();
+
+  light.on(t0);
+  light.off();
+  CHECK(!light.isOn());
+  CHECK_EQ(fake::outputLevel(2), LOW);
+  CHECK_EQ(light.remainingMs(t0 + 1), 0UL);
+  CHECK(!light.update(t0 + 120000));
+}
+
+void testButtonDebounceAndRefractory() {
+  Button button;
+  button.begin();
+
+  // Past the refractory window that also applies right after boot
+  fake::advance(1200);
+  unsigned long t0 = millis();
+
+  // Press: confirmed after a 10ms debounce, reported once and latched
+  fake::setLevel(9, HIGH);
+  CHECK(button.justPressed(t0));
+  CHECK_EQ(millis() - t0, 10UL);
+  CHECK(button.isLatched());
+  CHECK(!button.justPressed(t0 + 2000));
+
+  // Release at +500ms is ignored until the 1200ms refractory ends
+  fake::setLevel(9, LOW);
+  CHECK(!button.justPressed(t0 + 500));
+  CHECK(button.isLatched());
+  CHECK(!button.justPressed(t0 + 1199));
+  CHECK(button.isLatched());
+  CHECK(!button.justPressed(t0 + 1200));
+  CHECK(!button.isLatched());
+
+  // The release restarts the refractory window
+  fake::setLevel(9, HIGH);
+  CHECK(!button.justPressed(t0 + 2399));
+  CHECK(button.justPressed(t0 + 2400));
+}
+
+void testButtonBounceIsIgnored() {
+  Button button;
+  button.begin();
+  fake::advance(1200);
+  unsigned long t0 = millis();
+
+  // HIGH on the first read, LOW on the confirmation read
+  fake::scriptDigital(9, {HIGH, LOW});
+  CHECK(!button.justPressed(t0));
+  CHECK_EQ(millis() - t0, 10UL);
+  CHECK(!button.isLatched());
+}
+
+void testButtonLockedOutAfterBoot() {
+  Button button;
+  button.begin();
+  fake::setLevel(9, HIGH);
+  CHECK(!button.justPressed(1199));
+  CHECK(button.justPressed(1200));
+}
+
+void testDoorSensorDoubleRead() {
+  DoorSensor sensor;
+  sensor.begin();
+
+  fake::setLevel(11, HIGH);
+  CHECK(sensor.read());
+  CHECK_EQ(fake::lastDelayUs(), 10U);
+
+  fake::scriptDigital(11, {HIGH, LOW});
+  CHECK(!sensor.read());
+  fake::scriptDigital(11, {LOW, HIGH});
+  CHECK(!sensor.read());
+
+  fake::setLevel(11, LOW);
+  CHECK(!sensor.read());
+}
+
+void testNightSensorHighIsNight() {
+  NightSensor sensor;
+  sensor.begin();
+  fake::setLevel(12, HIGH);
+  CHECK(sensor.read());
+  fake::setLevel(12, LOW);
+  CHECK(!sensor.read());
+}
+
+void testDebugLedFollowsWrite() {
+  DebugLed led;
+  led.begin();
+  led.write(true);
+  CHECK_EQ(fake::outputLevel(LED_BUILTIN), HIGH);
+  led.write(false);
+  CHECK_EQ(fake::outputLevel(LED_BUILTIN), LOW);
+}
+
+int main() {
+  RUN_TEST(testBeginDrivesOutputsLow, 0UL);
+  RUN_TEST_WRAP(testDoorPulseLasts400ms);
+  RUN_TEST_WRAP(testLightDefaultTimeoutIs120s);
+  RUN_TEST_WRAP(testLightRequestedDurationAndRestart);
+  RUN_TEST_WRAP(testLightTimeoutFollowsMillis);
+  RUN_TEST_WRAP(testLightOffCancelsTimeout);
+  RUN_TEST(testButtonDebounceAndRefractory, 0UL);
+  RUN_TEST(testButtonDebounceAndRefractory, 0xFFFFFA00UL);
+  RUN_TEST(testButtonBounceIsIgnored, 0UL);
+  RUN_TEST(testButtonBounceIsIgnored, 0xFFFFFA00UL);
+  RUN_TEST(testButtonLockedOutAfterBoot, 0UL);
+  RUN_TEST(testDoorSensorDoubleRead, 0UL);
+  RUN_TEST(testNightSensorHighIsNight, 0UL);
+  RUN_TEST(testDebugLedFollowsWrite, 0UL);
+  return testSummary("garage_test");
+}
@@ -0,0 +1,258 @@
+/*
+ * Garage light rules engine: scheduling, repeats, re-triggers and edits
+ *
+ * rulesUpdate() reads the real door and LDR inputs from components.h,
+ * driven through the fake pins; loopFor() stands in for the sketch's
+ * loop(), which also runs the light timeout.
+ */
+
+#include "test.h"
+#include "../../garage-iot-controller/src/rules.h"
+
+void mxShowStatus() {}
+
+// Door closed reads HIGH on both samples; the LDR reads HIGH at night
+static void setDoorClosed(bool closed) { fake::setLevel(PIN_DOOR_DIGITAL, closed ? HIGH : LOW); }
+static void setNight(bool night) { fake::setLevel(PIN_LDR_DIGITAL, night == LDR_HIGH_IS_NIGHT ? HIGH : LOW); }
+
+// Number of times the light relay was switched on so far
+static unsigned int lightOnCount() {
+  unsigned int n = 0;
+  for (const fake::PinWrite& w : fake::writes()) n += (w.pin == PIN_RELAY_LIGHT && w.level == HIGH);
+  return n;
+}
+
+static void loopFor(unsigned long ms) {
+  for (unsigned long t = 0; t < ms; t += 100) {
+    fake::advance(100);
+    light.update(millis());
+    rulesUpdate(millis());
+  }
+}
+
+// Closed door during the day, levels latched by a first pass
+static void startRules() {
+  ruleCount = 0;
+  pendingActions.clear();
+  doorEdge = DoorEdge();
+  nightEdge = NightEdge();
+  light.begin();
+  doorSensor.begin();
+  nightSensor.begin();
+  setDoorClosed(true);
+  setNight(false);
+  rulesUpdate(millis());
+}
+
+static LightRule makeRule(uint8_t trigger, uint8_t when, uint8_t action, uint32_t delaySec,
+                          uint32_t durationSec = 0, uint32_t repeatSec = 0, uint8_t count = 0) {
+  LightRule r = {trigger, when, action, count, delaySec, durationSec, repeatSec};
+  return r;
+}
+
+// The new level is first seen on the next pass and must then hold
+// DOOR_SETTLE_MS; the rules are armed on the last pass of these helpers
+static void openDoor() {
+  setDoorClosed(false);
+  loopFor(DOOR_SETTLE_MS + 100);
+}
+
+static void closeDoor() {
+  setDoorClosed(true);
+  loopFor(DOOR_SETTLE_MS + 100);
+}
+
+void testDelayedActionRunsOnce() {
+  startRules();
+  rulesAdd(makeRule(TRIGGER_DOOR_OPEN, WHEN_ALWAYS, ACTION_LAMP_ON, 10, 5));
+  openDoor();
+  CHECK_EQ(pendingActions.size(), 1U);
+
+  loopFor(9900);
+  CHECK(!light.isOn());
+  loopFor(100);
+  CHECK(light.isOn());
+  CHECK_EQ(light.remainingMs(millis()), 5000UL);
+  CHECK(pendingActions.empty());
+
+  loopFor(5000);
+  CHECK(!light.isOn());
+  CHECK_EQ(lightOnCount(), 1U);
+}
+
+void testRepeatReschedulesFromDeadline() {
+  startRules();
+  rulesAdd(makeRule(TRIGGER_DOOR_OPEN, WHEN_ALWAYS, ACTION_LAMP_ON, 10, 5, 60, 2));
+  openDoor();
+  unsigned long armed = millis();
+
+  // A late loop pass runs the action late, but the next run keeps its slot
+  fake::advance(10000 + 300);
+  rulesUpdate(millis());
+  CHECK_EQ(lightOnCount(), 1U);
+  CHECK_EQ(pendingActions.size(), 1U);
+  CHECK_EQ(pendingActions.top().deadline - armed, 70000UL);
+  CHECK_EQ(pendingActions.top().remaining, 1U);
+
+  loopFor(70000 - 10300 - 100);
+  CHECK_EQ(lightOnCount(), 1U);
+  loopFor(100);
+  CHECK_EQ(lightOnCount(), 2U);
+  CHECK_EQ(pendingActions.top().remaining, 0U);
+
+  loopFor(60000);
+  CHECK_EQ(lightOnCount(), 3U);
+  CHECK(pendingActions.empty());
+
+  loopFor(120000);
+  CHECK_EQ(lightOnCount(), 3U);
+}
+
+void testRetriggerRestartsSchedule() {
+  startRules();
+  rulesAdd(makeRule(TRIGGER_DOOR_OPEN, WHEN_ALWAYS, ACTION_LAMP_ON, 60, 5, 30, 3));
+  openDoor();
+  unsigned long first = millis();
+
+  // First run and one repeat used up
+  loopFor(90000);
+  CHECK_EQ(lightOnCount(), 2U);
+  CHECK_EQ(pendingActions.top().remaining, 1U);
+
+  // Opening again replaces the pending run and restores the full count
+  closeDoor();
+  openDoor();
+  unsigned long second = millis();
+  CHECK_EQ(pendingActions.size(), 1U);
+  CHECK_EQ(pendingActions.top().deadline - second, 60000UL);
+  CHECK_EQ(pendingActions.top().remaining, 3U);
+
+  // The old slot at first + 120s passes without a run
+  loopFor(core::sinceMs(first + 120000, millis()));
+  CHECK_EQ(lightOnCount(), 2U);
+  loopFor(core::sinceMs(second + 60000, millis()));
+  CHECK_EQ(lightOnCount(), 3U);
+}
+
+void testConditionIsCheckedAtTrigger() {
+  startRules();
+  rulesAdd(makeRule(TRIGGER_DOOR_OPEN, WHEN_NIGHT, ACTION_LAMP_ON, 0));
+  openDoor();
+  CHECK(pendingActions.empty());
+  closeDoor();
+
+  // Night needs NIGHT_SETTLE_MS to count, but the condition reads the level
+  setNight(true);
+  openDoor();
+  loopFor(100);
+  CHECK(light.isOn());
+  CHECK_EQ(light.remainingMs(millis()), core::secondsToMs(LIGHT_DEFAULT_SECONDS) - 100);
+}
+
+void testNightTriggerFollowsLdrSettle() {
+  startRules();
+  rulesAdd(makeRule(TRIGGER_NIGHT, WHEN_ALWAYS, ACTION_LAMP_OFF, 0));
+  rulesAdd(makeRule(TRIGGER_DAY, WHEN_ALWAYS, ACTION_LAMP_ON, 0));
+  setNight(true);
+  loopFor(NIGHT_SETTLE_MS);
+  CHECK(pendingActions.empty());
+  light.on(millis());
+  loopFor(100);
+  CHECK(!light.isOn());
+}
+
+void testAddKeepsPendingActions() {
+  startRules();
+  rulesAdd(makeRule(TRIGGER_DOOR_OPEN, WHEN_ALWAYS, ACTION_LAMP_ON, 10, 7));
+  openDoor();
+  rulesAdd(makeRule(TRIGGER_DOOR_CLOSE, WHEN_ALWAYS, ACTION_LAMP_OFF, 0));
+  CHECK_EQ(pendingActions.size(), 1U);
+
+  loopFor(10000);
+  CHECK(light.isOn());
+  CHECK_EQ(light.remainingMs(millis()), 7000UL);
+}
+
+void testRemoveRenumbersPendingActions() {
+  startRules();
+  rulesAdd(makeRule(TRIGGER_DOOR_OPEN, WHEN_ALWAYS, ACTION_LAMP_ON, 10, 3));
+  rulesAdd(makeRule(TRIGGER_DOOR_OPEN, WHEN_ALWAYS, ACTION_LAMP_ON, 20, 20));
+  rulesAdd(makeRule(TRIGGER_DOOR_OPEN, WHEN_ALWAYS, ACTION_LAMP_OFF, 30));
+  openDoor();
+  CHECK_EQ(pendingActions.size(), 3U);
+
+  // Rule #0 goes: its run is dropped, #1 and #2 become #0 and #1
+  CHECK(rulesRemove(0));
+  CHECK_EQ(ruleCount, 2U);
+  CHECK_EQ(pendingActions.size(), 2U);
+  CHECK_EQ(pendingActions.top().rule, 0U);
+
+  loopFor(10000);
+  CHECK(!light.isOn());
+  loopFor(10000);
+  CHECK(light.isOn());
+  CHECK_EQ(light.remainingMs(millis()), 20000UL);
+  loopFor(5000);
+  CHECK(light.isOn());
+  CHECK_EQ(pendingActions.top().rule, 1U);
+  loopFor(5000);
+  CHECK(!light.isOn());
+  CHECK(pendingActions.empty());
+
+  CHECK(!rulesRemove(2));
+  CHECK(!rulesRemove(-1));
+}
+
+void testRemoveLastKeepsEarlierRules() {
+  startRules();
+  rulesAdd(makeRule(TRIGGER_DOOR_OPEN, WHEN_ALWAYS, ACTION_LAMP_ON, 10));
+  rulesAdd(makeRule(TRIGGER_DOOR_OPEN, WHEN_ALWAYS, ACTION_LAMP_OFF, 5));
+  openDoor();
+
+  CHECK(rulesRemove(1));
+  CHECK_EQ(pendingActions.size(), 1U);
+  CHECK_EQ(pendingActions.top().rule, 0U);
+  loopFor(10000);
+  CHECK(light.isOn());
+}
+
+void testClearDropsEverything() {
+  startRules();
+  rulesAdd(makeRule(TRIGGER_DOOR_OPEN, WHEN_ALWAYS, ACTION_LAMP_ON, 10));
+  openDoor();
+  rulesClear();
+  CHECK_EQ(ruleCount, 0U);
+  CHECK(pendingActions.empty());
+}
+
+void testRulesSurviveReload() {
+  startRules();
+  rulesLoad();
+  CHECK_EQ(ruleCount, 0U);
+
+  rulesAdd(makeRule(TRIGGER_DAY, WHEN_ALWAYS, ACTION_LAMP_OFF, 300));
+  rulesAdd(makeRule(TRIGGER_DOOR_CLOSE, WHEN_NIGHT, ACTION_LAMP_ON, 0, 60, 600, 3));
+  rulesRemove(0);
+  rulesLoad();
+
+  CHECK_EQ(ruleCount, 1U);
+  CHECK_EQ(rules[0].trigger, TRIGGER_DOOR_CLOSE);
+  CHECK_EQ(rules[0].when, WHEN_NIGHT);
+  CHECK_EQ(rules[0].durationSec, 60U);
+  CHECK_EQ(rules[0].repeatSec, 600U);
+  CHECK_EQ(rules[0].repeatCount, 3U);
+}
+
+int main() {
+  RUN_TEST_WRAP(testDelayedActionRunsOnce);
+  RUN_TEST_WRAP(testRepeatReschedulesFromDeadline);
+  RUN_TEST_WRAP(testRetriggerRestartsSchedule);
+  RUN_TEST(testConditionIsCheckedAtTrigger, 0UL);
+  RUN_TEST(testNightTriggerFollowsLdrSettle, 0UL);
+  RUN_TEST_WRAP(testAddKeepsPendingActions);
+  RUN_TEST_WRAP(testRemoveRenumbersPendingActions);
+  RUN_TEST(testRemoveLastKeepsEarlierRules, 0UL);
+  RUN_TEST(testClearDropsEverything, 0UL);
+  RUN_TEST(testRulesSurviveReload, 0UL);
+  return testSummary("rules_test");
+}
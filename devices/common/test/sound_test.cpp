@@ -0,0 +1,141 @@
+/*
+ * Sound system configuration against the pre-template behaviour
+ *
+ * Expected values are the ones the original sketch hard-coded (TV 20
+ * samples / 200ms at threshold 4, Chromecast 30 samples / 300ms at
+ * threshold 2, loss after 100 samples / 1s, 500ms relay pulses).
+ */
+
+#include "test.h"
+#include "../../sound-system/config.h"
+
+void testTvConfirmTakes200ms() {
+  TvSignal tv;
+  unsigned long t0 = millis();
+
+  fake::setAnalog(A5, 4);
+  CHECK(tv.present());
+  CHECK(tv.confirm());
+  CHECK_EQ(TvSignal::confirmMs, 200UL);
+  CHECK_EQ(millis() - t0, TvSignal::confirmMs);
+  CHECK_EQ(fake::analogReadCount(A5), 1U + 20U);
+
+  fake::setAnalog(A5, 3);
+  CHECK(!tv.present());
+}
+
+void testCcConfirmTakes300ms() {
+  CcSignal cc;
+  unsigned long t0 = millis();
+
+  fake::setAnalog(A4, 2);
+  CHECK(cc.present());
+  CHECK(cc.confirm());
+  CHECK_EQ(CcSignal::confirmMs, 300UL);
+  CHECK_EQ(millis() - t0, CcSignal::confirmMs);
+  CHECK_EQ(fake::analogReadCount(A4), 1U + 30U);
+
+  fake::setAnalog(A4, 1);
+  CHECK(!cc.present());
+}
+
+void testConfirmFailsOnSingleDip() {
+  TvSignal tv;
+  unsigned long t0 = millis();
+
+  std::vector<int> reads(20, 4);
+  reads[10] = 0;
+  fake::scriptAnalog(A5, reads);
+  CHECK(!tv.confirm());
+  CHECK_EQ(millis() - t0, 200UL);
+
+  // A dip on the last sample fails too
+  reads[10] = 4;
+  reads[19] = 0;
+  fake::scriptAnalog(A5, reads);
+  CHECK(!tv.confirm());
+}
+
+void testLossAfterOneSecondWithoutSignal() {
+  TvSignal tv;
+  unsigned long t0 = millis();
+
+  fake::setAnalog(A5, 0);
+  CHECK(tv.lost());
+  CHECK_EQ(TvSignal::lossMs, 1000UL);
+  CHECK_EQ(CcSignal::lossMs, 1000UL);
+  CHECK_EQ(millis() - t0, TvSignal::lossMs);
+  CHECK_EQ(fake::analogReadCount(A5), 100U);
+}
+
+void testLossMonitorReturnsWhenSignalSeen() {
+  CcSignal cc;
+  unsigned long t0 = millis();
+
+  // Signal on the first sample: one 10ms sample only
+  fake::setAnalog(A4, 2);
+  CHECK(!cc.lost());
+  CHECK_EQ(millis() - t0, 10UL);
+
+  // Signal back after three silent samples
+  t0 = millis();
+  fake::scriptAnalog(A4, {0, 0, 0, 2});
+  CHECK(!cc.lost());
+  CHECK_EQ(millis() - t0, 40UL);
+
+  // Signal back on the 100th sample: not lost
+  t0 = millis();
+  std::vector<int> reads(100, 0);
+  reads[99] = 2;
+  fake::scriptAnalog(A4, reads);
+  CHECK(!cc.lost());
+  CHECK_EQ(millis() - t0, 1000UL);
+}
+
+template <class Relay>
+void checkPulse500ms(Relay& relay, int pin) {
+  relay.begin();
+  unsigned long t0 = millis();
+  size_t first = fake::writes().size();
+
+  relay.pulseBlocking();
+
+  CHECK_EQ(millis() - t0, 500UL);
+  CHECK_EQ(fake::writes().size() - first, 2U);
+  const fake::PinWrite& high = fake::writes()[first];
+  const fake::PinWrite& low = fake::writes()[first + 1];
+  CHECK_EQ(high.pin, pin);
+  CHECK_EQ(high.level, HIGH);
+  CHECK_EQ(high.ms, t0);
+  CHECK_EQ(low.pin, pin);
+  CHECK_EQ(low.level, LOW);
+  CHECK_EQ(low.ms - t0, 500UL);
+}
+
+void testRelayPulsesLast500ms() {
+  PowerRelay power;
+  TvRelay tv;
+  CcRelay cc;
+  checkPulse500ms(power, 8);
+  checkPulse500ms(tv, 9);
+  checkPulse500ms(cc, 10);
+}
+
+void testInfoLedOnPin13() {
+  InfoLed led;
+  led.begin();
+  CHECK_EQ(fake::mode(13), OUTPUT);
+  led.write(true);
+  CHECK_EQ(fake::outputLevel(13), HIGH);
+}
+
+int main() {
+  RUN_TEST_WRAP(testTvConfirmTakes200ms);
+  RUN_TEST_WRAP(testCcConfirmTakes300ms);
+  RUN_TEST(testConfirmFailsOnSingleDip, 0UL);
+  RUN_TEST_WRAP(testLossAfterOneSecondWithoutSignal);
+  RUN_TEST(testLossMonitorReturnsWhenSignalSeen, 0UL);
+  RUN_TEST_WRAP(testRelayPulsesLast500ms);
+  RUN_TEST(testInfoLedOnPin13, 0UL);
+  return testSummary("sound_test");
+}
@@ -0,0 +1,55 @@
+#ifndef TEST_H
+#define TEST_H
+
+// Minimal assertion helpers: each test program is a single translation unit
+
+#include <stdio.h>
+
+#include "Arduino.h"
+
+static int testFailures = 0;
+
+#define CHECK(cond)                                                      \
+  do {                                                                   \
+    if (!(cond)) {                                                       \
+      printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);           \
+      testFailures++;                                                    \
+    }                                                                    \
+  } while (0)
+
+// Compared as 32-bit values, the width of unsigned long on the boards, so
+// millis() differences such as millis() - t0 are right across the wrap
+#define CHECK_EQ(actual, expected)                                       \
+  do {                                                                   \
+    uint32_t a_ = (uint32_t)(actual);                                    \
+    uint32_t e_ = (uint32_t)(expected);                                  \
+    if (a_ != e_) {                                                      \
+      printf("  FAIL %s:%d: %s == %lu, expected %lu\n",                  \
+             __FILE__, __LINE__, #actual, (unsigned long)a_,             \
+             (unsigned long)e_);                                         \
+      testFailures++;                                                    \
+    }                                                                    \
+  } while (0)
+
+// Every test starts from a clean fake board at the given millis()
+#define RUN_TEST(fn, startMs)                                            \
+  do {                                                                   \
+    fake::reset(startMs);                                                \
+    int before_ = testFailures;                                          \
+    fn();                                                                \
+    printf("%s %s\n", testFailures == before_ ? "[ OK ]" : "[FAIL]", #fn); \
+  } while (0)
+
+// Both RUN_TEST variants: from boot and just before millis() wraps
+#define RUN_TEST_WRAP(fn)                                                \
+  do {                                                                   \
+    RUN_TEST(fn, 0UL);                                                   \
+    RUN_TEST(fn, 0xFFFFFF00UL);                                          \
+  } while (0)
+
+static int testSummary(const char* suite) {
+  printf("%s: %s\n", suite, testFailures ? "FAILED" : "passed");
+  return testFailures ? 1 : 0;
+}
+
+#endif
@@ -2,16 +2,11 @@
 #define API_SERVER_H
 
 #include <WiFiS3.h>
+#include "components.h"
+#include "rules.h"
 
 extern WiFiServer server;
-extern bool isDoorClosed();
-extern bool isNightNow();
-extern bool lightOn;
-extern unsigned long lightStartMs;
-extern unsigned long lightDurationMs;
-extern const unsigned long LIGHT_DEFAULT_SECONDS;
 extern void handleDoorAction(const char* source, long requestedSeconds);
-extern void setLight(bool on);
 extern void mxShowStatus();
 void sendJson(WiFiClient& client, int code, const String& body) {
   client.println("HTTP/1.1 " + String(code) + " OK");
@@ -101,6 +96,36 @@ long jsonDurationSec(const String& body, long fallback) {
   return num.length() ? num.toInt() : fallback;
 }
 
+bool jsonHasKey(const String& body, const char* key) {
+  return body.indexOf(String("\"") + String(key) + "\"") >= 0;
+}
+
+// Reads a non-negative integer <= max into value. A missing key leaves value
+// untouched; false when the key is present with anything else (-1, 1.5, "abc")
+bool jsonGetUnsigned(const String& body, const char* key, long max, long& value) {
+  if (!jsonHasKey(body, key)) return true;
+  String v = jsonGetValue(body, key);
+  if (v.length() == 0 || v.length() > 9) return false;
+  for (unsigned int i = 0; i < v.length(); i++) {
+    if (!isDigit(v[i])) return false;
+  }
+  long n = v.toInt();
+  if (n > max) return false;
+  value = n;
+  return true;
+}
+
+String normalizeBody(const String& body) {
+  String normalizedBody = body;
+  normalizedBody.replace("\n", "");
+  normalizedBody.replace("\r", "");
+  normalizedBody.replace("\t", " ");
+  while (normalizedBody.indexOf("  ") >= 0) {
+    normalizedBody.replace("  ", " ");
+  }
+  return normalizedBody;
+}
+
 void handleStatus(WiFiClient& client) {
   Serial.print("[API] GET /status from ");
   Serial.println(client.remoteIP());
@@ -109,12 +134,8 @@ void handleStatus(WiFiClient& client) {
   bool night  = isNightNow();
 
   String doorStr  = closed ? "closed" : "open";
-  String lightStr = lightOn ? "on" : "off";
-  unsigned long remaining = 0;
-  if (lightOn) {
-    unsigned long el = millis() - lightStartMs;
-    remaining = (el >= lightDurationMs) ? 0 : (lightDurationMs - el);
-  }
+  String lightStr = light.isOn() ? "on" : "off";
+  unsigned long remaining = light.remainingMs(millis());
 
   bool wifiConnected = (WiFi.status() == WL_CONNECTED);
   String localIP = wifiConnected ? ipToString(WiFi.localIP()) : "0.0.0.0";
@@ -148,13 +169,7 @@ void handleSet(WiFiClient& client, const String& body) {
   Serial.print("[API] Body length: ");
   Serial.println(body.length());
   
-  String normalizedBody = body;
-  normalizedBody.replace("\n", "");
-  normalizedBody.replace("\r", "");
-  normalizedBody.replace("\t", " ");
-  while (normalizedBody.indexOf("  ") >= 0) {
-    normalizedBody.replace("  ", " ");
-  }
+  String normalizedBody = normalizeBody(body);
   Serial.print("[API] Normalized body: ");
   Serial.println(normalizedBody);
   
@@ -208,8 +223,7 @@ void handleSet(WiFiClient& client, const String& body) {
     if (action == "on") {
       long dur = jsonDurationSec(normalizedBody, (long)LIGHT_DEFAULT_SECONDS);
       if (dur <= 0) dur = LIGHT_DEFAULT_SECONDS;
-      lightDurationMs = (unsigned long)dur * 1000UL;
-      setLight(true);
+      light.on(millis(), core::secondsToMs((unsigned long)dur));
       Serial.print("[API] Lamp ON requested (duration: ");
       Serial.print(dur);
       Serial.println(" s)");
@@ -219,7 +233,7 @@ void handleSet(WiFiClient& client, const String& body) {
     }
     
     if (action == "off") {
-      setLight(false);
+      light.off();
       Serial.println("[API] Lamp OFF requested");
       mxShowStatus();
       sendJson(client, 200, "{\"result\":\"ok\",\"message\":\"Lamp off\"}");
@@ -235,6 +249,136 @@ void handleSet(WiFiClient& client, const String& body) {
   sendJson(client, 400, "{\"result\":\"error\",\"message\":\"Unknown device. Use 'door' or 'lamp'\"}");
 }
 
+void handleRulesGet(WiFiClient& client) {
+  Serial.print("[API] GET /rules from ");
+  Serial.println(client.remoteIP());
+
+  String json = "{\"rules\":[";
+  for (uint8_t i = 0; i < ruleCount; i++) {
+    if (i > 0) json += ",";
+    json += ruleToJson(i);
+  }
+  json += "],";
+  json += "\"capacity\":" + String(MAX_LIGHT_RULES) + ",";
+  json += "\"pending\":" + String(pendingActions.size());
+  json += "}";
+  sendJson(client, 200, json);
+}
+
+void handleRulesAdd(WiFiClient& client, const String& body) {
+  Serial.print("[API] POST /rules from ");
+  Serial.print(client.remoteIP());
+  Serial.print(" - Body: ");
+  Serial.println(body);
+
+  String normalizedBody = normalizeBody(body);
+  String trigger = jsonGetValue(normalizedBody, "trigger");
+  String when    = jsonGetValue(normalizedBody, "when");
+  String action  = jsonGetValue(normalizedBody, "action");
+  trigger.toLowerCase();
+  when.toLowerCase();
+  action.toLowerCase();
+  if (when.length() == 0) when = "always";
+
+  int t = ruleNameIndex(TRIGGER_NAMES, TRIGGER_COUNT, trigger);
+  int w = ruleNameIndex(WHEN_NAMES, WHEN_COUNT, when);
+  int a = ruleNameIndex(ACTION_NAMES, ACTION_COUNT, action);
+  if (t < 0) {
+    sendJson(client, 400, "{\"result\":\"error\",\"message\":\"Unknown trigger. Use 'door_open', 'door_close', 'night' or 'day'\"}");
+    return;
+  }
+  if (w < 0) {
+    sendJson(client, 400, "{\"result\":\"error\",\"message\":\"Unknown condition. Use 'always', 'night' or 'day'\"}");
+    return;
+  }
+  if (a < 0) {
+    sendJson(client, 400, "{\"result\":\"error\",\"message\":\"Unknown rule action. Use 'on' or 'off'\"}");
+    return;
+  }
+
+  long delaySec = 0, durationSec = 0, repeatSec = 0, count = 0;
+  if (!jsonGetUnsigned(normalizedBody, "delay", (long)RULE_MAX_SECONDS, delaySec) ||
+      !jsonGetUnsigned(normalizedBody, "duration", (long)RULE_MAX_SECONDS, durationSec) ||
+      !jsonGetUnsigned(normalizedBody, "repeat", (long)RULE_MAX_SECONDS, repeatSec)) {
+    sendJson(client, 400, "{\"result\":\"error\",\"message\":\"Times must be whole seconds from 0 to " + String(RULE_MAX_SECONDS) + "\"}");
+    return;
+  }
+  if (!jsonGetUnsigned(normalizedBody, "count", 255, count)) {
+    sendJson(client, 400, "{\"result\":\"error\",\"message\":\"'count' must be a whole number from 0 to 255\"}");
+    return;
+  }
+  // No default count: a repeat without one, or a count without a repeat, is a mistake
+  if ((repeatSec > 0) != (count > 0)) {
+    sendJson(client, 400, "{\"result\":\"error\",\"message\":\"Set both 'repeat' and 'count' above 0, or neither\"}");
+    return;
+  }
+
+  LightRule r;
+  r.trigger     = (uint8_t)t;
+  r.when        = (uint8_t)w;
+  r.action      = (uint8_t)a;
+  r.repeatCount = (uint8_t)count;
+  r.delaySec    = (uint32_t)delaySec;
+  r.durationSec = (uint32_t)durationSec;
+  r.repeatSec   = (uint32_t)repeatSec;
+
+  if (!rulesAdd(r)) {
+    sendJson(client, 400, "{\"result\":\"error\",\"message\":\"Rule table is full\"}");
+    return;
+  }
+  Serial.print("[API] Rule added: ");
+  Serial.println(ruleToJson(ruleCount - 1));
+  sendJson(client, 200, "{\"result\":\"ok\",\"message\":\"Rule added\",\"id\":" + String(ruleCount - 1) + "}");
+}
+
+void handleRulesDelete(WiFiClient& client, const String& body) {
+  Serial.print("[API] DELETE /rules from ");
+  Serial.print(client.remoteIP());
+  Serial.print(" - Body: ");
+  Serial.println(body);
+
+  // Deleting everything must be explicit: a missing or mistyped id is an error
+  String normalizedBody = normalizeBody(body);
+  bool hasId = jsonHasKey(normalizedBody, "id");
+  bool hasAll = jsonHasKey(normalizedBody, "all");
+  if (hasId == hasAll) {
+    sendJson(client, 400, "{\"result\":\"error\",\"message\":\"Use {\\\"id\\\": N} or {\\\"all\\\": true}\"}");
+    return;
+  }
+  if (hasAll) {
+    if (!(jsonGetValue(normalizedBody, "all") == "true")) {
+      sendJson(client, 400, "{\"result\":\"error\",\"message\":\"'all' must be true\"}");
+      return;
+    }
+    rulesClear();
+    Serial.println("[API] All rules deleted");
+    sendJson(client, 200, "{\"result\":\"ok\",\"message\":\"All rules deleted\"}");
+    return;
+  }
+
+  long id = -1;
+  if (!jsonGetUnsigned(normalizedBody, "id", MAX_LIGHT_RULES - 1, id)) {
+    sendJson(client, 400, "{\"result\":\"error\",\"message\":\"'id' must be a rule id from GET /rules\"}");
+    return;
+  }
+  if (!rulesRemove((int)id)) {
+    sendJson(client, 400, "{\"result\":\"error\",\"message\":\"Unknown rule id\"}");
+    return;
+  }
+  Serial.print("[API] Rule deleted: #");
+  Serial.println(id);
+  sendJson(client, 200, "{\"result\":\"ok\",\"message\":\"Rule deleted\"}");
+}
+
+String readBody(WiFiClient& client, int contentLength) {
+  String body;
+  for (int i=0; i<contentLength; ++i) {
+    while (!client.available()) { delay(1); }
+    body += (char)client.read();
+  }
+  return body;
+}
+
 void processHttpRequests() {
   if (WiFi.status() == WL_CONNECTED) {
     WiFiClient client = server.available();
@@ -252,18 +396,22 @@ void processHttpRequests() {
         }
       }
       
-      bool getStatus = reqLine.startsWith("GET /status");
-      bool postSet   = reqLine.startsWith("POST /set");
+      bool getStatus   = reqLine.startsWith("GET /status");
+      bool postSet     = reqLine.startsWith("POST /set");
+      bool getRules    = reqLine.startsWith("GET /rules");
+      bool postRules   = reqLine.startsWith("POST /rules");
+      bool deleteRules = reqLine.startsWith("DELETE /rules");
 
       if (getStatus) {
         handleStatus(client);
       } else if (postSet) {
-        String body;
-        for (int i=0; i<contentLength; ++i) {
-          while (!client.available()) { delay(1); }
-          body += (char)client.read();
-        }
-        handleSet(client, body);
+        handleSet(client, readBody(client, contentLength));
+      } else if (getRules) {
+        handleRulesGet(client);
+      } else if (postRules) {
+        handleRulesAdd(client, readBody(client, contentLength));
+      } else if (deleteRules) {
+        handleRulesDelete(client, readBody(client, contentLength));
       } else {
         Serial.print("[API] 404 - Unknown request: ");
         Serial.println(reqLine);
@@ -0,0 +1,25 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include "config.h"
+
+// Component instances, defined once here for the sketch and every header
+// that drives them (the sketch builds as a single translation unit)
+LightRelay  light;
+DoorRelay   doorRelay;
+DebugLed    debugLed;
+Button      button;
+DoorSensor  doorSensor;
+NightSensor nightSensor;
+
+bool isNightNow() {
+  return nightSensor.read();
+}
+
+bool isDoorClosed() {
+  // Double read to filter out noise and floating pin states
+  // Only returns true if both reads are HIGH (door closed = HIGH signal)
+  return doorSensor.read();
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <controller_core.h>
+
+// Pin map
+const int PIN_RELAY_LIGHT    = 2;
+const int PIN_RELAY_DOOR     = 3;
+const int PIN_DISPLAY_ENABLE = 6;
+const int PIN_BUTTON_DIGITAL = 9;
+const int PIN_DOOR_DIGITAL   = 11;
+const int PIN_LDR_DIGITAL    = 12;
+const int PIN_LED_DEBUG      = LED_BUILTIN;
+
+// Configuration
+const bool LDR_HIGH_IS_NIGHT = true;
+
+// Timing
+const unsigned long LIGHT_DEFAULT_SECONDS = 120;
+const unsigned long DOOR_PULSE_MS         = 400;
+const unsigned long BUTTON_DEBOUNCE_MS    = 10;
+const unsigned long BUTTON_REFRACT_MS     = 1200;
+const unsigned int  DOOR_CONFIRM_US       = 10;
+
+// Light rules
+const uint8_t       MAX_LIGHT_RULES       = 8;      // Rules stored in EEPROM
+const unsigned long RULE_MAX_SECONDS      = 86400;  // Upper bound for delay/duration/repeat
+const unsigned long DOOR_SETTLE_MS        = 500;    // Door level must hold this long to trigger rules
+const unsigned long NIGHT_SETTLE_MS       = 10000;  // LDR level must hold this long to trigger rules
+const int           RULES_EEPROM_ADDR     = 0;
+
+// Device components: every pin and timing value is fixed at compile time
+typedef core::TimedOutput<PIN_RELAY_LIGHT, core::secondsToMs(LIGHT_DEFAULT_SECONDS)> LightRelay;
+typedef core::PulseRelay<PIN_RELAY_DOOR, DOOR_PULSE_MS> DoorRelay;
+typedef core::Output<PIN_LED_DEBUG> DebugLed;
+typedef core::LatchedButton<PIN_BUTTON_DIGITAL, BUTTON_DEBOUNCE_MS, BUTTON_REFRACT_MS> Button;
+typedef core::ConfirmedInput<PIN_DOOR_DIGITAL, DOOR_CONFIRM_US> DoorSensor;
+typedef core::LevelInput<PIN_LDR_DIGITAL, LDR_HIGH_IS_NIGHT> NightSensor;
+typedef core::EdgeDetector<DOOR_SETTLE_MS> DoorEdge;
+typedef core::EdgeDetector<NIGHT_SETTLE_MS> NightEdge;
+
+static_assert(core::secondsToMs(RULE_MAX_SECONDS) < 0x7FFFFFFFUL, "Rule timers must stay within the wrap-safe millis() range");
+
+#endif
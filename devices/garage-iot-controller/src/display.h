@@ -3,16 +3,10 @@
 
 #include <Arduino_LED_Matrix.h>
 #include <WiFiS3.h>
+#include "components.h"
 
 ArduinoLEDMatrix matrix;
 
-extern bool isDoorClosed();
-extern bool isNightNow();
-extern bool lightOn;
-extern bool doorPulseActive;
-extern bool buttonLatched;
-extern const int PIN_DISPLAY_ENABLE;
-
 unsigned long ipDisplayStartTime = 0;
 bool ipDisplayActive = false;
 uint8_t ipLastOctet = 0;
@@ -131,11 +125,11 @@ void mxShowStatus() {
   
   if (night) drawBlock2x2(frame, 0, 0);        // Night sensor
   if (doorClosed) drawBlock2x2(frame, 3, 0);   // Door closed
-  if (buttonLatched) drawBlock2x2(frame, 6, 0); // Button pressed
+  if (button.isLatched()) drawBlock2x2(frame, 6, 0); // Button pressed
   
   // Row 4: Outputs (3x3 blocks)
-  if (lightOn) drawBlock3x3(frame, 0, 4);      // Light ON
-  if (doorPulseActive) drawBlock3x3(frame, 4, 4); // Door relay active
+  if (light.isOn()) drawBlock3x3(frame, 0, 4);    // Light ON
+  if (doorRelay.isActive()) drawBlock3x3(frame, 4, 4); // Door relay active
   
   // Column 10-11: WiFi connection indicator (vertical bar)
   if (wifiConnected) {
@@ -0,0 +1,204 @@
+#ifndef RULES_H
+#define RULES_H
+
+#include <EEPROM.h>
+#include "components.h"
+
+extern void mxShowStatus();
+
+// Transition that arms a rule
+enum RuleTrigger : uint8_t {
+  TRIGGER_DOOR_OPEN,
+  TRIGGER_DOOR_CLOSE,
+  TRIGGER_NIGHT,
+  TRIGGER_DAY,
+  TRIGGER_COUNT
+};
+
+// Condition checked when the trigger fires
+enum RuleCondition : uint8_t {
+  WHEN_ALWAYS,
+  WHEN_NIGHT,
+  WHEN_DAY,
+  WHEN_COUNT
+};
+
+enum RuleAction : uint8_t {
+  ACTION_LAMP_ON,
+  ACTION_LAMP_OFF,
+  ACTION_COUNT
+};
+
+// Persisted as-is in EEPROM: only fixed-size fields
+struct LightRule {
+  uint8_t  trigger;
+  uint8_t  when;
+  uint8_t  action;
+  uint8_t  repeatCount;   // Extra runs after the first one
+  uint32_t delaySec;      // From trigger to first run
+  uint32_t durationSec;   // Lamp on time (0 = default)
+  uint32_t repeatSec;     // Interval between runs
+};
+
+// Pending run of a rule, ordered by deadline in the action queue
+struct TimedAction {
+  unsigned long deadline;
+  uint8_t rule;
+  uint8_t remaining;
+};
+
+struct RulesHeader {
+  uint16_t magic;
+  uint8_t  version;
+  uint8_t  count;
+};
+
+const uint16_t RULES_MAGIC   = 0x4E48;  // "NH"
+const uint8_t  RULES_VERSION = 1;
+
+const char* const TRIGGER_NAMES[TRIGGER_COUNT] = {"door_open", "door_close", "night", "day"};
+const char* const WHEN_NAMES[WHEN_COUNT]       = {"always", "night", "day"};
+const char* const ACTION_NAMES[ACTION_COUNT]   = {"on", "off"};
+
+// Each rule has at most one pending action, so the queue can never overflow
+typedef core::DeadlineQueue<TimedAction, MAX_LIGHT_RULES> ActionQueue;
+
+LightRule   rules[MAX_LIGHT_RULES];
+uint8_t     ruleCount = 0;
+ActionQueue pendingActions;
+DoorEdge    doorEdge;
+NightEdge   nightEdge;
+
+int ruleNameIndex(const char* const names[], int count, const String& name) {
+  for (int i = 0; i < count; i++) {
+    if (name == names[i]) return i;
+  }
+  return -1;
+}
+
+void rulesSave() {
+  RulesHeader h = {RULES_MAGIC, RULES_VERSION, ruleCount};
+  EEPROM.put(RULES_EEPROM_ADDR, h);
+  for (uint8_t i = 0; i < ruleCount; i++) {
+    EEPROM.put(RULES_EEPROM_ADDR + (int)sizeof(RulesHeader) + i * (int)sizeof(LightRule), rules[i]);
+  }
+}
+
+void rulesLoad() {
+  RulesHeader h;
+  EEPROM.get(RULES_EEPROM_ADDR, h);
+  ruleCount = 0;
+  if (h.magic != RULES_MAGIC || h.version != RULES_VERSION || h.count > MAX_LIGHT_RULES) {
+    Serial.println("[RULE] No stored rules");
+    return;
+  }
+  for (uint8_t i = 0; i < h.count; i++) {
+    LightRule r;
+    EEPROM.get(RULES_EEPROM_ADDR + (int)sizeof(RulesHeader) + i * (int)sizeof(LightRule), r);
+    if (r.trigger >= TRIGGER_COUNT || r.when >= WHEN_COUNT || r.action >= ACTION_COUNT) continue;
+    rules[ruleCount++] = r;
+  }
+  Serial.print("[RULE] Loaded ");
+  Serial.print(ruleCount);
+  Serial.println(" rule(s) from EEPROM");
+}
+
+// New rules are appended, so pending actions of the others keep their index
+bool rulesAdd(const LightRule& r) {
+  if (ruleCount >= MAX_LIGHT_RULES) return false;
+  rules[ruleCount++] = r;
+  rulesSave();
+  return true;
+}
+
+bool rulesRemove(int id) {
+  if (id < 0 || id >= ruleCount) return false;
+  for (uint8_t i = (uint8_t)id; i + 1 < ruleCount; i++) rules[i] = rules[i + 1];
+  ruleCount--;
+  // Drop the removed rule's actions and follow the ids that shifted down
+  pendingActions.removeIf([id](const TimedAction& a) { return a.rule == id; });
+  pendingActions.forEach([id](TimedAction& a) {
+    if (a.rule > id) a.rule--;
+  });
+  rulesSave();
+  return true;
+}
+
+void rulesClear() {
+  ruleCount = 0;
+  pendingActions.clear();
+  rulesSave();
+}
+
+String ruleToJson(uint8_t id) {
+  const LightRule& r = rules[id];
+  String json = "{";
+  json += "\"id\":" + String(id) + ",";
+  json += "\"trigger\":\"" + String(TRIGGER_NAMES[r.trigger]) + "\",";
+  json += "\"when\":\"" + String(WHEN_NAMES[r.when]) + "\",";
+  json += "\"action\":\"" + String(ACTION_NAMES[r.action]) + "\",";
+  json += "\"delay\":" + String((unsigned long)r.delaySec) + ",";
+  json += "\"duration\":" + String((unsigned long)r.durationSec) + ",";
+  json += "\"repeat\":" + String((unsigned long)r.repeatSec) + ",";
+  json += "\"count\":" + String(r.repeatCount);
+  json += "}";
+  return json;
+}
+
+void runRuleAction(const LightRule& r, unsigned long now) {
+  if (r.action == ACTION_LAMP_ON) {
+    unsigned long sec = r.durationSec ? r.durationSec : LIGHT_DEFAULT_SECONDS;
+    light.on(now, core::secondsToMs(sec));
+    Serial.print("[RULE] Light ON for "); Serial.print(sec); Serial.println(" s");
+  } else {
+    light.off();
+    Serial.println("[RULE] Light OFF");
+  }
+  mxShowStatus();
+}
+
+// Re-triggering a rule restarts its schedule
+void armRules(uint8_t trigger, bool night, unsigned long now) {
+  for (uint8_t i = 0; i < ruleCount; i++) {
+    const LightRule& r = rules[i];
+    if (r.trigger != trigger) continue;
+    if ((r.when == WHEN_NIGHT && !night) || (r.when == WHEN_DAY && night)) continue;
+
+    pendingActions.removeIf([i](const TimedAction& a) { return a.rule == i; });
+    TimedAction a = {now + core::secondsToMs(r.delaySec), i, r.repeatCount};
+    pendingActions.push(a);
+    Serial.print("[RULE] #"); Serial.print(i);
+    Serial.print(" armed by "); Serial.print(TRIGGER_NAMES[trigger]);
+    Serial.print(", runs in "); Serial.print((unsigned long)r.delaySec); Serial.println(" s");
+  }
+}
+
+void rulesBegin() {
+  rulesLoad();
+}
+
+void rulesUpdate(unsigned long now) {
+  // Door/night transitions arm the matching rules
+  bool night = isNightNow();
+  if (doorEdge.update(isDoorClosed(), now)) {
+    armRules(doorEdge.state() ? TRIGGER_DOOR_CLOSE : TRIGGER_DOOR_OPEN, night, now);
+  }
+  if (nightEdge.update(night, now)) {
+    armRules(nightEdge.state() ? TRIGGER_NIGHT : TRIGGER_DAY, night, now);
+  }
+
+  // Only the earliest deadline is checked on each pass
+  while (pendingActions.due(now)) {
+    TimedAction a = pendingActions.top();
+    pendingActions.pop();
+    const LightRule& r = rules[a.rule];
+    runRuleAction(r, now);
+    if (a.remaining > 0 && r.repeatSec > 0) {
+      a.deadline += core::secondsToMs(r.repeatSec);
+      a.remaining--;
+      pendingActions.push(a);
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,825 @@
+/*
+ * Garage IoT Controller - API load and latency benchmark
+ * -----------------------------------------------------
+ *
+ * Replays the requests of the Postman collection open-loop against a board
+ * (or any host serving the same API) at a fixed rate and concurrency, and
+ * reports latency percentiles, error rates and connection failures as JSON.
+ * A previous report can be passed as baseline to flag regressions.
+ *
+ * Open-loop: request i is scheduled at start + i / rate. At most
+ * --concurrency requests are in flight, so once every worker is busy the
+ * actual sends slip behind schedule; latency is measured from the scheduled
+ * time, not the actual send, so that slip is counted as queueing delay
+ * instead of hiding behind a lower request rate. Timed-out requests stay in
+ * the latency data with the time at which they were abandoned.
+ *
+ * Percentiles need enough samples per request: with fewer than 100 p99 is
+ * just the maximum, with fewer than 1000 so is p999. The report lists a
+ * warning for every request below those counts.
+ *
+ * Build (host, POSIX):
+ *   g++ -std=c++17 -O2 -pthread api_bench.cpp -o api_bench
+ *
+ * devices/common/test/bench_test.cpp builds this file with API_BENCH_NO_MAIN
+ * to check the statistics and baseline comparison on known samples.
+ */
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// ============================================================================
+// MINIMAL JSON (collection and baseline parsing)
+// ============================================================================
+
+struct Json {
+  enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+  Type type = NUL;
+  bool boolean = false;
+  double number = 0;
+  std::string str;
+  std::vector<Json> items;
+  std::vector<std::pair<std::string, Json>> members;
+
+  const Json* get(const std::string& key) const {
+    for (const auto& m : members) {
+      if (m.first == key) return &m.second;
+    }
+    return nullptr;
+  }
+
+  std::string getString(const std::string& key, const std::string& fallback = "") const {
+    const Json* v = get(key);
+    return (v && v->type == STRING) ? v->str : fallback;
+  }
+
+  double getNumber(const std::string& key, double fallback = 0) const {
+    const Json* v = get(key);
+    return (v && v->type == NUMBER) ? v->number : fallback;
+  }
+};
+
+class JsonParser {
+ public:
+  explicit JsonParser(const std::string& text) : s_(text) {}
+
+  bool parse(Json& out) {
+    if (!value(out)) return false;
+    skipSpace();
+    return pos_ == s_.size();
+  }
+
+ private:
+  const std::string& s_;
+  size_t pos_ = 0;
+
+  void skipSpace() {
+    while (pos_ < s_.size() && isspace((unsigned char)s_[pos_])) pos_++;
+  }
+
+  bool literal(const char* word) {
+    size_t n = strlen(word);
+    if (s_.compare(pos_, n, word) != 0) return false;
+    pos_ += n;
+    return true;
+  }
+
+  bool value(Json& out) {
+    skipSpace();
+    if (pos_ >= s_.size()) return false;
+    char c = s_[pos_];
+    if (c == '{') return object(out);
+    if (c == '[') return array(out);
+    if (c == '"') { out.type = Json::STRING; return string(out.str); }
+    if (literal("true"))  { out.type = Json::BOOL; out.boolean = true; return true; }
+    if (literal("false")) { out.type = Json::BOOL; out.boolean = false; return true; }
+    if (literal("null"))  { out.type = Json::NUL; return true; }
+    return number(out);
+  }
+
+  bool object(Json& out) {
+    out.type = Json::OBJECT;
+    pos_++;
+    skipSpace();
+    if (pos_ < s_.size() && s_[pos_] == '}') { pos_++; return true; }
+    while (true) {
+      skipSpace();
+      std::string key;
+      if (pos_ >= s_.size() || s_[pos_] != '"' || !string(key)) return false;
+      skipSpace();
+      if (pos_ >= s_.size() || s_[pos_++] != ':') return false;
+      Json v;
+      if (!value(v)) return false;
+      out.members.emplace_back(key, std::move(v));
+      skipSpace();
+      if (pos_ >= s_.size()) return false;
+      if (s_[pos_] == ',') { pos_++; continue; }
+      if (s_[pos_] == '}') { pos_++; return true; }
+      return false;
+    }
+  }
+
+  bool array(Json& out) {
+    out.type = Json::ARRAY;
+    pos_++;
+    skipSpace();
+    if (pos_ < s_.size() && s_[pos_] == ']') { pos_++; return true; }
+    while (true) {
+      Json v;
+      if (!value(v)) return false;
+      out.items.push_back(std::move(v));
+      skipSpace();
+      if (pos_ >= s_.size()) return false;
+      if (s_[pos_] == ',') { pos_++; continue; }
+      if (s_[pos_] == ']') { pos_++; return true; }
+      return false;
+    }
+  }
+
+  bool string(std::string& out) {
+    pos_++;  // Opening quote
+    while (pos_ < s_.size()) {
+      char c = s_[pos_++];
+      if (c == '"') return true;
+      if (c != '\\') { out += c; continue; }
+      if (pos_ >= s_.size()) return false;
+      char e = s_[pos_++];
+      switch (e) {
+        case 'n': out += '\n'; break;
+        case 't': out += '\t'; break;
+        case 'r': out += '\r'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'u': {
+          if (pos_ + 4 > s_.size()) return false;
+          unsigned cp = (unsigned)strtoul(s_.substr(pos_, 4).c_str(), nullptr, 16);
+          pos_ += 4;
+          // UTF-8 encode (BMP only, enough for collection descriptions)
+          if (cp < 0x80) {
+            out += (char)cp;
+          } else if (cp < 0x800) {
+            out += (char)(0xC0 | (cp >> 6));
+            out += (char)(0x80 | (cp & 0x3F));
+          } else {
+            out += (char)(0xE0 | (cp >> 12));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+          }
+          break;
+        }
+        default: out += e; break;
+      }
+    }
+    return false;
+  }
+
+  bool number(Json& out) {
+    const char* start = s_.c_str() + pos_;
+    char* end = nullptr;
+    out.number = strtod(start, &end);
+    if (end == start) return false;
+    out.type = Json::NUMBER;
+    pos_ += (size_t)(end - start);
+    return true;
+  }
+};
+
+std::string jsonEscape(const std::string& in) {
+  std::string out;
+  for (char c : in) {
+    switch (c) {
+      case '"':  out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:   out += c; break;
+    }
+  }
+  return out;
+}
+
+bool readFile(const std::string& path, std::string& out) {
+  std::ifstream f(path, std::ios::binary);
+  if (!f) return false;
+  std::stringstream ss;
+  ss << f.rdbuf();
+  out = ss.str();
+  return true;
+}
+
+bool loadJsonFile(const std::string& path, Json& out) {
+  std::string text;
+  if (!readFile(path, text)) {
+    fprintf(stderr, "[BENCH] Cannot read %s\n", path.c_str());
+    return false;
+  }
+  if (!JsonParser(text).parse(out)) {
+    fprintf(stderr, "[BENCH] Invalid JSON in %s\n", path.c_str());
+    return false;
+  }
+  return true;
+}
+
+// ============================================================================
+// POSTMAN COLLECTION
+// ============================================================================
+
+struct Target {
+  std::string host;
+  int port = 80;
+
+  // Also the Host header value
+  std::string str() const { return host + (port == 80 ? "" : ":" + std::to_string(port)); }
+};
+
+// Each request keeps the host of its own URL; collections may mix hosts
+struct BenchRequest {
+  Target target;
+  std::string name;
+  std::string method;
+  std::string path;
+  std::vector<std::pair<std::string, std::string>> headers;
+  std::string body;
+};
+
+std::string substituteVars(std::string text, const std::map<std::string, std::string>& vars) {
+  for (const auto& v : vars) {
+    std::string token = "{{" + v.first + "}}";
+    size_t p;
+    while ((p = text.find(token)) != std::string::npos) text.replace(p, token.size(), v.second);
+  }
+  return text;
+}
+
+// Splits "http://host[:port]/path" into target and path
+bool parseUrl(const std::string& url, Target& target, std::string& path) {
+  std::string rest = url;
+  const std::string scheme = "http://";
+  if (rest.compare(0, scheme.size(), scheme) == 0) {
+    rest = rest.substr(scheme.size());
+  } else if (rest.find("://") != std::string::npos) {
+    return false;  // Only plain HTTP is served by the controllers
+  }
+  size_t slash = rest.find('/');
+  std::string hostPort = rest.substr(0, slash);
+  path = (slash == std::string::npos) ? "/" : rest.substr(slash);
+  size_t colon = hostPort.find(':');
+  target.host = hostPort.substr(0, colon);
+  target.port = (colon == std::string::npos) ? 80 : atoi(hostPort.c_str() + colon + 1);
+  return !target.host.empty() && target.port > 0;
+}
+
+// Collects requests from the collection, descending into folders
+void collectRequests(const Json& items, const std::map<std::string, std::string>& vars,
+                     std::vector<BenchRequest>& out) {
+  for (const Json& item : items.items) {
+    if (const Json* sub = item.get("item")) {
+      collectRequests(*sub, vars, out);
+      continue;
+    }
+    const Json* req = item.get("request");
+    if (!req) continue;
+
+    BenchRequest r;
+    r.name = item.getString("name", "unnamed");
+    r.method = req->getString("method", "GET");
+
+    std::string raw;
+    if (const Json* url = req->get("url")) {
+      raw = (url->type == Json::STRING) ? url->str : url->getString("raw");
+    }
+    if (!parseUrl(substituteVars(raw, vars), r.target, r.path)) {
+      fprintf(stderr, "[BENCH] Skipping '%s': unsupported URL '%s'\n", r.name.c_str(), raw.c_str());
+      continue;
+    }
+
+    if (const Json* headers = req->get("header")) {
+      for (const Json& h : headers->items) {
+        r.headers.emplace_back(h.getString("key"), substituteVars(h.getString("value"), vars));
+      }
+    }
+    if (const Json* body = req->get("body")) {
+      r.body = substituteVars(body->getString("raw"), vars);
+    }
+    out.push_back(r);
+  }
+}
+
+std::string toLower(std::string s) {
+  for (auto& c : s) c = (char)tolower((unsigned char)c);
+  return s;
+}
+
+// True for requests that would pulse the real door relay. handleSet()
+// lowercases "device" and finds keys without a strict parser, so match
+// case-insensitively and treat an unparsable body that mentions the door
+// as a door request
+bool targetsDoor(const BenchRequest& r) {
+  if (r.body.empty()) return false;
+  Json body;
+  if (!JsonParser(r.body).parse(body)) return toLower(r.body).find("\"door\"") != std::string::npos;
+  return toLower(body.getString("device")) == "door";
+}
+
+// True for requests that rewrite the rules stored in EEPROM
+bool modifiesRules(const BenchRequest& r) {
+  return r.method != "GET" && r.path.compare(0, 6, "/rules") == 0;
+}
+
+// ============================================================================
+// HTTP CLIENT
+// ============================================================================
+
+enum Outcome { OUTCOME_OK, OUTCOME_HTTP_ERROR, OUTCOME_CONNECT_FAILED, OUTCOME_TIMEOUT, OUTCOME_BAD_RESPONSE };
+
+struct Sample {
+  size_t request;
+  Outcome outcome;
+  int status;
+  double latencyMs;  // From scheduled send time to full response
+};
+
+bool waitFd(int fd, short events, Clock::time_point deadline) {
+  while (true) {
+    long remaining = (long)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    if (remaining <= 0) return false;
+    pollfd p = {fd, events, 0};
+    int rc = poll(&p, 1, (int)remaining);
+    if (rc > 0) return true;
+    if (rc < 0 && errno != EINTR) return false;
+  }
+}
+
+int connectWithTimeout(const sockaddr_storage& addr, socklen_t len, Clock::time_point deadline) {
+  int fd = socket(addr.ss_family, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  if (connect(fd, (const sockaddr*)&addr, len) == 0) return fd;
+  if (errno == EINPROGRESS && waitFd(fd, POLLOUT, deadline)) {
+    int err = 0;
+    socklen_t errLen = sizeof(err);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errLen) == 0 && err == 0) return fd;
+  }
+  close(fd);
+  return -1;
+}
+
+// Resolved address of a target, looked up once before the run
+struct Endpoint {
+  sockaddr_storage addr;
+  socklen_t len;
+  std::string hostHeader;
+};
+
+bool resolveTarget(const Target& target, Endpoint& out) {
+  addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* res = nullptr;
+  std::string port = std::to_string(target.port);
+  if (getaddrinfo(target.host.c_str(), port.c_str(), &hints, &res) != 0 || !res) return false;
+  out.addr = sockaddr_storage();
+  out.len = res->ai_addrlen;
+  memcpy(&out.addr, res->ai_addr, res->ai_addrlen);
+  freeaddrinfo(res);
+  out.hostHeader = target.str();
+  return true;
+}
+
+Outcome sendRequest(const Endpoint& ep, const BenchRequest& r, int timeoutMs, int& status) {
+  status = 0;
+  Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+  int fd = connectWithTimeout(ep.addr, ep.len, deadline);
+  if (fd < 0) return Clock::now() >= deadline ? OUTCOME_TIMEOUT : OUTCOME_CONNECT_FAILED;
+
+  std::string msg = r.method + " " + r.path + " HTTP/1.1\r\n";
+  msg += "Host: " + ep.hostHeader + "\r\n";
+  for (const auto& h : r.headers) msg += h.first + ": " + h.second + "\r\n";
+  if (!r.body.empty() || r.method == "POST") msg += "Content-Length: " + std::to_string(r.body.size()) + "\r\n";
+  msg += "Connection: close\r\n\r\n";
+  msg += r.body;
+
+  size_t sent = 0;
+  while (sent < msg.size()) {
+    if (!waitFd(fd, POLLOUT, deadline)) { close(fd); return OUTCOME_TIMEOUT; }
+    ssize_t n = send(fd, msg.data() + sent, msg.size() - sent, MSG_NOSIGNAL);
+    if (n < 0 && errno != EAGAIN && errno != EINTR) { close(fd); return OUTCOME_BAD_RESPONSE; }
+    if (n > 0) sent += (size_t)n;
+  }
+
+  // The controllers always answer with Content-Length and close the connection
+  std::string resp;
+  char buf[1024];
+  size_t headerEnd = std::string::npos;
+  long contentLength = -1;
+  while (true) {
+    if (headerEnd != std::string::npos && contentLength >= 0 &&
+        resp.size() >= headerEnd + 4 + (size_t)contentLength) {
+      break;
+    }
+    if (!waitFd(fd, POLLIN, deadline)) { close(fd); return OUTCOME_TIMEOUT; }
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n == 0) break;
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EINTR) continue;
+      break;
+    }
+    resp.append(buf, (size_t)n);
+    if (headerEnd == std::string::npos && (headerEnd = resp.find("\r\n\r\n")) != std::string::npos) {
+      std::string head = toLower(resp.substr(0, headerEnd));
+      size_t cl = head.find("content-length:");
+      if (cl != std::string::npos) contentLength = atol(head.c_str() + cl + 15);
+    }
+  }
+  close(fd);
+
+  if (resp.compare(0, 5, "HTTP/") != 0) return OUTCOME_BAD_RESPONSE;
+  size_t sp = resp.find(' ');
+  if (sp == std::string::npos) return OUTCOME_BAD_RESPONSE;
+  status = atoi(resp.c_str() + sp + 1);
+  if (status <= 0) return OUTCOME_BAD_RESPONSE;
+  return (status >= 200 && status < 300) ? OUTCOME_OK : OUTCOME_HTTP_ERROR;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+// Below these per-request sample counts the percentile is just the maximum
+const size_t MIN_SAMPLES_P99 = 100;
+const size_t MIN_SAMPLES_P999 = 1000;
+
+struct Stats {
+  size_t count = 0;
+  size_t ok = 0;
+  size_t httpErrors = 0;
+  size_t connectFailures = 0;
+  size_t timeouts = 0;
+  size_t badResponses = 0;
+  std::map<int, size_t> statusCodes;
+  std::vector<double> latencies;  // Responses and timeouts, not refused connections
+
+  void add(const Sample& s) {
+    count++;
+    switch (s.outcome) {
+      case OUTCOME_OK:             ok++; break;
+      case OUTCOME_HTTP_ERROR:     httpErrors++; break;
+      case OUTCOME_CONNECT_FAILED: connectFailures++; break;
+      case OUTCOME_TIMEOUT:        timeouts++; break;
+      case OUTCOME_BAD_RESPONSE:   badResponses++; break;
+    }
+    if (s.status > 0) statusCodes[s.status]++;
+    // A timeout is at least as slow as the time it was abandoned at; leaving
+    // it out would make the tail look better the worse the server gets
+    if (s.status > 0 || s.outcome == OUTCOME_TIMEOUT) latencies.push_back(s.latencyMs);
+  }
+
+  double errorRate() const {
+    return count ? (double)(count - ok) / (double)count : 0.0;
+  }
+
+  // Sorts the latencies; call once after the last add()
+  void finalize() {
+    std::sort(latencies.begin(), latencies.end());
+  }
+
+  // Nearest-rank percentile, only valid after finalize()
+  double percentile(double p) const {
+    if (latencies.empty()) return 0.0;
+    // The epsilon keeps e.g. 99.9% of 1000 at rank 999: 0.999 * 1000 is a hair above 999
+    size_t rank = (size_t)std::ceil(p / 100.0 * (double)latencies.size() - 1e-9);
+    if (rank == 0) rank = 1;
+    return latencies[std::min(rank, latencies.size()) - 1];
+  }
+};
+
+void writeStats(std::ostream& os, const Stats& s, const char* indent) {
+  double mean = 0;
+  for (double l : s.latencies) mean += l;
+  if (!s.latencies.empty()) mean /= (double)s.latencies.size();
+
+  char buf[512];
+  snprintf(buf, sizeof(buf),
+           "{\n%s  \"count\": %zu, \"ok\": %zu, \"http_errors\": %zu, \"connect_failures\": %zu,"
+           " \"timeouts\": %zu, \"bad_responses\": %zu, \"error_rate\": %.6f,\n"
+           "%s  \"latency_ms\": {\"samples\": %zu, \"p50\": %.3f, \"p99\": %.3f, \"p999\": %.3f, \"max\": %.3f, \"mean\": %.3f},\n"
+           "%s  \"status_codes\": {",
+           indent, s.count, s.ok, s.httpErrors, s.connectFailures, s.timeouts, s.badResponses, s.errorRate(),
+           indent, s.latencies.size(), s.percentile(50), s.percentile(99), s.percentile(99.9),
+           s.latencies.empty() ? 0.0 : s.latencies.back(), mean, indent);
+  os << buf;
+  bool first = true;
+  for (const auto& c : s.statusCodes) {
+    os << (first ? "" : ", ") << "\"" << c.first << "\": " << c.second;
+    first = false;
+  }
+  os << "}\n" << indent << "}";
+}
+
+// ============================================================================
+// BASELINE COMPARISON
+// ============================================================================
+
+struct Regression {
+  std::string scope;
+  std::string metric;
+  double baseline;
+  double current;
+};
+
+// Latency regresses when it grows more than tolerancePct and minDeltaMs;
+// error rate regresses when it grows more than errorTolerancePts percentage points
+void compareStats(const std::string& scope, const Stats& current, const Json& baseline, double tolerancePct,
+                  double minDeltaMs, double errorTolerancePts, std::vector<Regression>& out) {
+  if (const Json* lat = baseline.get("latency_ms")) {
+    const char* metrics[] = {"p50", "p99", "p999"};
+    const double pcts[] = {50, 99, 99.9};
+    for (int i = 0; i < 3; i++) {
+      const Json* b = lat->get(metrics[i]);
+      if (!b || b->type != Json::NUMBER) continue;
+      double cur = current.percentile(pcts[i]);
+      if (cur > b->number * (1.0 + tolerancePct / 100.0) && cur - b->number > minDeltaMs) {
+        out.push_back({scope, std::string("latency_ms.") + metrics[i], b->number, cur});
+      }
+    }
+  }
+  if (const Json* b = baseline.get("error_rate")) {
+    if (current.errorRate() > b->number + errorTolerancePts / 100.0) {
+      out.push_back({scope, "error_rate", b->number, current.errorRate()});
+    }
+  }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+struct Options {
+  std::string collection = "Garage_IoT_Controller.postman_collection.json";
+  std::string baseUrl;
+  double rate = 5.0;
+  double durationSec = 30.0;
+  int concurrency = 4;
+  int timeoutMs = 2000;
+  std::vector<std::string> only;
+  bool allowDoor = false;
+  bool allowRules = false;
+  std::string output;
+  std::string baseline;
+  double tolerancePct = 20.0;
+  double minDeltaMs = 5.0;
+  double errorTolerancePts = 1.0;
+};
+
+void usage() {
+  fprintf(stderr,
+          "Usage: api_bench [options]\n"
+          "  --collection PATH    Postman collection (default: %s)\n"
+          "  --base-url URL       Overrides {{base_url}}, e.g. http://192.168.1.190 or http://127.0.0.1:8080\n"
+          "  --rate N             Requests per second across all requests (default: 5)\n"
+          "  --duration S         Test duration in seconds (default: 30)\n"
+          "  --concurrency N      Max requests in flight (default: 4)\n"
+          "  --timeout-ms N       Per-request connect+response timeout (default: 2000)\n"
+          "  --only NAME          Only replay requests whose name contains NAME (repeatable)\n"
+          "  --allow-door         Also replay door requests (pulses the real door relay!)\n"
+          "  --allow-rules        Also replay requests that add/delete rules (writes EEPROM)\n"
+          "  --output PATH        Write the JSON report to PATH instead of stdout\n"
+          "  --baseline PATH      Compare against a previous report, exit 2 on regression\n"
+          "  --tolerance PCT      Allowed latency growth before flagging a regression (default: 20)\n"
+          "  --min-delta-ms N     Ignore latency growth below N ms (default: 5)\n"
+          "  --error-tolerance P  Allowed error rate growth in percentage points (default: 1)\n",
+          Options().collection.c_str());
+}
+
+bool parseArgs(int argc, char** argv, Options& o) {
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    auto next = [&](const char*& v) {
+      if (i + 1 >= argc) return false;
+      v = argv[++i];
+      return true;
+    };
+    const char* v = nullptr;
+    if (a == "--allow-door") { o.allowDoor = true; continue; }
+    if (a == "--allow-rules") { o.allowRules = true; continue; }
+    if (a == "--help" || a == "-h" || !next(v)) return false;
+    if (a == "--collection")        o.collection = v;
+    else if (a == "--base-url")     o.baseUrl = v;
+    else if (a == "--rate")         o.rate = atof(v);
+    else if (a == "--duration")     o.durationSec = atof(v);
+    else if (a == "--concurrency")  o.concurrency = atoi(v);
+    else if (a == "--timeout-ms")   o.timeoutMs = atoi(v);
+    else if (a == "--only")         o.only.push_back(v);
+    else if (a == "--output")       o.output = v;
+    else if (a == "--baseline")     o.baseline = v;
+    else if (a == "--tolerance")    o.tolerancePct = atof(v);
+    else if (a == "--min-delta-ms") o.minDeltaMs = atof(v);
+    else if (a == "--error-tolerance") o.errorTolerancePts = atof(v);
+    else return false;
+  }
+  return o.rate > 0 && o.durationSec > 0 && o.concurrency > 0 && o.timeoutMs > 0;
+}
+
+#ifndef API_BENCH_NO_MAIN
+int main(int argc, char** argv) {
+  Options opt;
+  if (!parseArgs(argc, argv, opt)) {
+    usage();
+    return 1;
+  }
+
+  Json collection;
+  if (!loadJsonFile(opt.collection, collection)) return 1;
+
+  std::map<std::string, std::string> vars;
+  if (const Json* variables = collection.get("variable")) {
+    for (const Json& v : variables->items) vars[v.getString("key")] = v.getString("value");
+  }
+  if (!opt.baseUrl.empty()) vars["base_url"] = opt.baseUrl;
+
+  std::vector<BenchRequest> all;
+  if (const Json* items = collection.get("item")) collectRequests(*items, vars, all);
+
+  std::vector<BenchRequest> requests;
+  for (const BenchRequest& r : all) {
+    if (!opt.allowDoor && targetsDoor(r)) continue;
+    if (!opt.allowRules && modifiesRules(r)) continue;
+    bool selected = opt.only.empty();
+    for (const std::string& o : opt.only) selected = selected || r.name.find(o) != std::string::npos;
+    if (selected) requests.push_back(r);
+  }
+  if (requests.empty()) {
+    fprintf(stderr, "[BENCH] No requests selected\n");
+    return 1;
+  }
+
+  // One lookup per distinct host; requestEndpoint[i] indexes endpoints
+  std::vector<Endpoint> endpoints;
+  std::vector<size_t> requestEndpoint;
+  std::map<std::string, size_t> endpointIndex;
+  std::string targets;
+  for (const BenchRequest& r : requests) {
+    std::string key = r.target.str();
+    auto it = endpointIndex.find(key);
+    if (it == endpointIndex.end()) {
+      Endpoint ep;
+      if (!resolveTarget(r.target, ep)) {
+        fprintf(stderr, "[BENCH] Cannot resolve %s\n", r.target.host.c_str());
+        return 1;
+      }
+      it = endpointIndex.emplace(key, endpoints.size()).first;
+      endpoints.push_back(ep);
+      targets += (targets.empty() ? "" : ", ") + key;
+    }
+    requestEndpoint.push_back(it->second);
+  }
+
+  fprintf(stderr, "[BENCH] Target %s, %zu request(s), %.1f req/s for %.1f s, concurrency %d\n",
+          targets.c_str(), requests.size(), opt.rate, opt.durationSec, opt.concurrency);
+  if (endpoints.size() > 1) {
+    fprintf(stderr, "[BENCH] Requests go to %zu different hosts; each is sent to its own URL\n", endpoints.size());
+  }
+
+  // Open-loop schedule: request i goes out at start + i / rate, round-robin
+  const size_t total = (size_t)std::llround(opt.rate * opt.durationSec);
+  const double intervalUs = 1e6 / opt.rate;
+  std::atomic<size_t> nextIndex(0);
+  std::vector<Sample> samples(total);
+  Clock::time_point start = Clock::now() + std::chrono::milliseconds(50);
+
+  auto worker = [&]() {
+    while (true) {
+      size_t i = nextIndex.fetch_add(1);
+      if (i >= total) return;
+      Clock::time_point scheduled = start + std::chrono::microseconds((long long)(intervalUs * (double)i));
+      std::this_thread::sleep_until(scheduled);
+      Sample s;
+      s.request = i % requests.size();
+      s.outcome = sendRequest(endpoints[requestEndpoint[s.request]], requests[s.request], opt.timeoutMs, s.status);
+      s.latencyMs = std::chrono::duration<double, std::milli>(Clock::now() - scheduled).count();
+      samples[i] = s;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < opt.concurrency; t++) threads.emplace_back(worker);
+  for (auto& t : threads) t.join();
+  double elapsedSec = std::chrono::duration<double>(Clock::now() - start).count();
+
+  Stats overall;
+  std::vector<Stats> perRequest(requests.size());
+  for (const Sample& s : samples) {
+    overall.add(s);
+    perRequest[s.request].add(s);
+  }
+  overall.finalize();
+  for (Stats& s : perRequest) s.finalize();
+
+  std::vector<Regression> regressions;
+  bool compared = false;
+  if (!opt.baseline.empty()) {
+    Json base;
+    if (!loadJsonFile(opt.baseline, base)) return 1;
+    compared = true;
+    if (const Json* b = base.get("overall")) {
+      compareStats("overall", overall, *b, opt.tolerancePct, opt.minDeltaMs, opt.errorTolerancePts, regressions);
+    }
+    if (const Json* b = base.get("requests")) {
+      for (size_t i = 0; i < requests.size(); i++) {
+        if (const Json* rb = b->get(requests[i].name)) {
+          compareStats(requests[i].name, perRequest[i], *rb, opt.tolerancePct, opt.minDeltaMs,
+                       opt.errorTolerancePts, regressions);
+        }
+      }
+    }
+  }
+
+  std::vector<std::string> warnings;
+  for (size_t i = 0; i < requests.size(); i++) {
+    size_t n = perRequest[i].latencies.size();
+    if (n >= MIN_SAMPLES_P999) continue;
+    warnings.push_back(requests[i].name + ": " + std::to_string(n) + " latency samples, " +
+                       (n < MIN_SAMPLES_P99 ? "p99 and p999 are" : "p999 is") +
+                       " the maximum; raise --rate or --duration");
+  }
+
+  std::ostringstream os;
+  os << "{\n";
+  os << "  \"target\": \"" << jsonEscape(targets) << "\",\n";
+  char cfg[256];
+  snprintf(cfg, sizeof(cfg),
+           "  \"config\": {\"rate\": %.3f, \"duration_s\": %.3f, \"concurrency\": %d, \"timeout_ms\": %d},\n"
+           "  \"elapsed_s\": %.3f,\n  \"throughput_rps\": %.3f,\n",
+           opt.rate, opt.durationSec, opt.concurrency, opt.timeoutMs,
+           elapsedSec, elapsedSec > 0 ? (double)overall.ok / elapsedSec : 0.0);
+  os << cfg;
+  os << "  \"overall\": ";
+  writeStats(os, overall, "  ");
+  os << ",\n  \"requests\": {";
+  for (size_t i = 0; i < requests.size(); i++) {
+    os << (i ? ",\n" : "\n") << "    \"" << jsonEscape(requests[i].name) << "\": ";
+    writeStats(os, perRequest[i], "    ");
+  }
+  os << "\n  },\n  \"warnings\": [";
+  for (size_t i = 0; i < warnings.size(); i++) {
+    os << (i ? ", " : "") << "\"" << jsonEscape(warnings[i]) << "\"";
+  }
+  os << "]";
+  if (compared) {
+    os << ",\n  \"baseline\": {\"file\": \"" << jsonEscape(opt.baseline) << "\", \"tolerance_pct\": " << opt.tolerancePct
+       << ", \"error_tolerance_pts\": " << opt.errorTolerancePts
+       << ", \"passed\": " << (regressions.empty() ? "true" : "false") << ", \"regressions\": [";
+    for (size_t i = 0; i < regressions.size(); i++) {
+      const Regression& r = regressions[i];
+      char buf[128];
+      snprintf(buf, sizeof(buf), "\"baseline\": %.6f, \"current\": %.6f}", r.baseline, r.current);
+      os << (i ? ", " : "") << "{\"scope\": \"" << jsonEscape(r.scope) << "\", \"metric\": \"" << r.metric << "\", " << buf;
+    }
+    os << "]}";
+  }
+  os << "\n}\n";
+
+  if (opt.output.empty()) {
+    fputs(os.str().c_str(), stdout);
+  } else {
+    std::ofstream f(opt.output);
+    if (!f) {
+      fprintf(stderr, "[BENCH] Cannot write %s\n", opt.output.c_str());
+      return 1;
+    }
+    f << os.str();
+    fprintf(stderr, "[BENCH] Report written to %s\n", opt.output.c_str());
+  }
+
+  for (const std::string& w : warnings) fprintf(stderr, "[BENCH] WARNING %s\n", w.c_str());
+  for (const Regression& r : regressions) {
+    fprintf(stderr, "[BENCH] REGRESSION %s %s: baseline %.3f -> current %.3f\n",
+            r.scope.c_str(), r.metric.c_str(), r.baseline, r.current);
+  }
+  return regressions.empty() ? 0 : 2;
+}
+#endif
@@ -12,41 +12,18 @@
  * for a period of time, the system automatically turns off.
  */
 
-// ============================================================================
-// PIN CONFIGURATION
-// ============================================================================
-
-// Sound inputs (analog pins)
-const int CC_SOUND_INPUT_PIN = A4;  // Chromecast in Phono input
-const int TV_SOUND_INPUT_PIN = A5;  // TV in CD input
-
-// Action relays output (digital pins)
-const int ON_RELAY_PIN = 8;   // Turn on/off the sound system
-const int TV_RELAY_PIN = 9;   // Switch to TV input (CD)
-const int CC_RELAY_PIN = 10;  // Switch to Chromecast input (Phono)
-
-// Info LED output (digital pin)
-const int LED_PIN = 13;
+#include "config.h"
 
 // ============================================================================
-// CONFIGURATION CONSTANTS
+// DEVICE INSTANCES
 // ============================================================================
 
-// Signal detection thresholds (0-1023 for 10-bit ADC)
-const int CC_THRESHOLD = 2;   // Minimum analog value to detect Chromecast signal
-const int TV_THRESHOLD = 4;   // Minimum analog value to detect TV signal
-
-// Timing constants (in milliseconds)
-const int RELAY_PULSE_DURATION = 500;      // Duration of relay pulse
-const int SIGNAL_CONFIRM_DELAY = 10;       // Delay between signal checks
-const int CC_CONFIRM_SAMPLES = 30;         // Number of samples to confirm CC signal (30 * 10ms = 300ms)
-const int TV_CONFIRM_SAMPLES = 20;         // Number of samples to confirm TV signal (20 * 10ms = 200ms)
-const int SIGNAL_LOSS_SAMPLES = 100;       // Samples before turning off (100 * 10ms = 1 second)
-const int LED_BLINK_DURATION = 150;        // LED blink duration on startup
-const int LOOP_DELAY = 50;                 // Delay in main loop to prevent excessive CPU usage
-
-// Serial communication
-const int SERIAL_BAUD_RATE = 9600;
+TvSignal   tvSignal;
+CcSignal   ccSignal;
+PowerRelay powerRelay;
+TvRelay    tvRelay;
+CcRelay    ccRelay;
+InfoLed    infoLed;
 
 // ============================================================================
 // STATE MANAGEMENT
@@ -65,17 +42,11 @@ SystemState currentState = STATE_OFF;
 // ============================================================================
 
 void setup() {
-  // Configure pins
-  pinMode(LED_PIN, OUTPUT);
-  pinMode(ON_RELAY_PIN, OUTPUT);
-  pinMode(TV_RELAY_PIN, OUTPUT);
-  pinMode(CC_RELAY_PIN, OUTPUT);
-  
-  // Ensure all relays are off initially
-  digitalWrite(ON_RELAY_PIN, LOW);
-  digitalWrite(TV_RELAY_PIN, LOW);
-  digitalWrite(CC_RELAY_PIN, LOW);
-  digitalWrite(LED_PIN, LOW);
+  // Configure pins (relays and LED start off)
+  infoLed.begin();
+  powerRelay.begin();
+  tvRelay.begin();
+  ccRelay.begin();
 
   // Initialize serial communication
   Serial.begin(SERIAL_BAUD_RATE);
@@ -104,7 +75,7 @@ void loop() {
       currentState = STATE_TV_ACTIVE;
     }
     // Monitor TV signal while active
-    monitorActiveSignal(TV_SOUND_INPUT_PIN, TV_THRESHOLD, "TV");
+    if (tvSignal.lost()) reportSignalLost("TV");
   }
   // Check Chromecast signal if TV is not active
   else if (checkCcSignalLevel()) {
@@ -115,7 +86,7 @@ void loop() {
       currentState = STATE_CC_ACTIVE;
     }
     // Monitor Chromecast signal while active
-    monitorActiveSignal(CC_SOUND_INPUT_PIN, CC_THRESHOLD, "Chromecast");
+    if (ccSignal.lost()) reportSignalLost("Chromecast");
   }
   // No signal detected
   else {
@@ -138,11 +109,7 @@ void loop() {
  * @return true if signal is confirmed, false otherwise
  */
 bool checkCcSignalLevel() {
-  int signalLevel = analogRead(CC_SOUND_INPUT_PIN);
-  if (signalLevel >= CC_THRESHOLD) {
-    return confirmSignal(CC_SOUND_INPUT_PIN, CC_THRESHOLD, CC_CONFIRM_SAMPLES);
-  }
-  return false;
+  return ccSignal.present() && ccSignal.confirm();
 }
 
 /**
@@ -150,59 +117,14 @@ bool checkCcSignalLevel() {
  * @return true if signal is confirmed, false otherwise
  */
 bool checkTvSignalLevel() {
-  int signalLevel = analogRead(TV_SOUND_INPUT_PIN);
-  if (signalLevel >= TV_THRESHOLD) {
-    return confirmSignal(TV_SOUND_INPUT_PIN, TV_THRESHOLD, TV_CONFIRM_SAMPLES);
-  }
-  return false;
+  return tvSignal.present() && tvSignal.confirm();
 }
 
 /**
- * Confirms that a signal is stable by checking multiple samples
- * @param pin The analog pin to read from
- * @param threshold The minimum value to consider as signal
- * @param samples Number of consecutive samples required
- * @return true if signal is confirmed stable, false otherwise
+ * Logs that the active signal was lost for the whole loss window
+ * @param sourceName Name of the signal source
  */
-bool confirmSignal(int pin, int threshold, int samples) {
-  int validSamples = 0;
-  
-  for (int i = 0; i < samples; i++) {
-    if (analogRead(pin) >= threshold) {
-      validSamples++;
-    } else {
-      validSamples = 0; // Reset counter if signal drops
-    }
-    delay(SIGNAL_CONFIRM_DELAY);
-  }
-  
-  return (validSamples >= samples);
-}
-
-/**
- * Monitors an active signal and turns off system if signal is lost
- * @param pin The analog pin to monitor
- * @param threshold The minimum value to consider as signal
- * @param sourceName Name of the signal source (for logging)
- */
-void monitorActiveSignal(int pin, int threshold, const char* sourceName) {
-  int noSignalCount = 0;
-  
-  for (int i = 0; i < SIGNAL_LOSS_SAMPLES; i++) {
-    if (analogRead(pin) < threshold) {
-      noSignalCount++;
-    } else {
-      noSignalCount = 0; // Reset if signal returns
-    }
-    delay(SIGNAL_CONFIRM_DELAY);
-    
-    // If signal returns, exit monitoring
-    if (noSignalCount == 0) {
-      return;
-    }
-  }
-  
-  // Signal lost for required duration
+void reportSignalLost(const char* sourceName) {
   Serial.print(sourceName);
   Serial.println(" signal lost - System will turn off");
 }
@@ -216,7 +138,7 @@ void monitorActiveSignal(int pin, int threshold, const char* sourceName) {
  */
 void turnOnSystem() {
   Serial.println("Turning ON sound system...");
-  pulseRelay(ON_RELAY_PIN);
+  powerRelay.pulseBlocking();
   delay(100); // Small delay after turning on
 }
 
@@ -225,7 +147,7 @@ void turnOnSystem() {
  */
 void turnOffSystem() {
   Serial.println("Turning OFF sound system...");
-  pulseRelay(ON_RELAY_PIN);
+  powerRelay.pulseBlocking();
   delay(100); // Small delay after turning off
 }
 
@@ -234,7 +156,7 @@ void turnOffSystem() {
  */
 void switchToCc() {
   Serial.println("Switching to Chromecast input (Phono)");
-  pulseRelay(CC_RELAY_PIN);
+  ccRelay.pulseBlocking();
 }
 
 /**
@@ -242,17 +164,7 @@ void switchToCc() {
  */
 void switchToTv() {
   Serial.println("Switching to TV input (CD)");
-  pulseRelay(TV_RELAY_PIN);
-}
-
-/**
- * Pulses a relay pin for the configured duration
- * @param pin The relay pin to pulse
- */
-void pulseRelay(int pin) {
-  digitalWrite(pin, HIGH);
-  delay(RELAY_PULSE_DURATION);
-  digitalWrite(pin, LOW);
+  tvRelay.pulseBlocking();
 }
 
 // ============================================================================
@@ -265,9 +177,9 @@ void pulseRelay(int pin) {
  */
 void blinkLED(int times) {
   for (int i = 0; i < times; i++) {
-    digitalWrite(LED_PIN, HIGH);
+    infoLed.write(true);
     delay(LED_BLINK_DURATION);
-    digitalWrite(LED_PIN, LOW);
+    infoLed.write(false);
     if (i < times - 1) {
       delay(LED_BLINK_DURATION);
     }
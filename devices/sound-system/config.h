@@ -0,0 +1,54 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <controller_core.h>
+
+// ============================================================================
+// PIN CONFIGURATION
+// ============================================================================
+
+// Sound inputs (analog pins)
+const int CC_SOUND_INPUT_PIN = A4;  // Chromecast in Phono input
+const int TV_SOUND_INPUT_PIN = A5;  // TV in CD input
+
+// Action relays output (digital pins)
+const int ON_RELAY_PIN = 8;   // Turn on/off the sound system
+const int TV_RELAY_PIN = 9;   // Switch to TV input (CD)
+const int CC_RELAY_PIN = 10;  // Switch to Chromecast input (Phono)
+
+// Info LED output (digital pin)
+const int LED_PIN = 13;
+
+// ============================================================================
+// CONFIGURATION CONSTANTS
+// ============================================================================
+
+// Signal detection thresholds (0-1023 for 10-bit ADC)
+const int CC_THRESHOLD = 2;   // Minimum analog value to detect Chromecast signal
+const int TV_THRESHOLD = 4;   // Minimum analog value to detect TV signal
+
+// Timing constants (in milliseconds)
+const int RELAY_PULSE_DURATION = 500;      // Duration of relay pulse
+const int SIGNAL_CONFIRM_DELAY = 10;       // Delay between signal checks
+const int CC_CONFIRM_SAMPLES = 30;         // Number of samples to confirm CC signal (30 * 10ms = 300ms)
+const int TV_CONFIRM_SAMPLES = 20;         // Number of samples to confirm TV signal (20 * 10ms = 200ms)
+const int SIGNAL_LOSS_SAMPLES = 100;       // Samples before turning off (100 * 10ms = 1 second)
+const int LED_BLINK_DURATION = 150;        // LED blink duration on startup
+const int LOOP_DELAY = 50;                 // Delay in main loop to prevent excessive CPU usage
+
+// Serial communication
+const int SERIAL_BAUD_RATE = 9600;
+
+// ============================================================================
+// DEVICE COMPONENTS
+// ============================================================================
+
+// Every pin, threshold and timing value is fixed at compile time
+typedef core::AnalogSignal<TV_SOUND_INPUT_PIN, TV_THRESHOLD, TV_CONFIRM_SAMPLES, SIGNAL_LOSS_SAMPLES, SIGNAL_CONFIRM_DELAY> TvSignal;
+typedef core::AnalogSignal<CC_SOUND_INPUT_PIN, CC_THRESHOLD, CC_CONFIRM_SAMPLES, SIGNAL_LOSS_SAMPLES, SIGNAL_CONFIRM_DELAY> CcSignal;
+typedef core::PulseRelay<ON_RELAY_PIN, RELAY_PULSE_DURATION> PowerRelay;
+typedef core::PulseRelay<TV_RELAY_PIN, RELAY_PULSE_DURATION> TvRelay;
+typedef core::PulseRelay<CC_RELAY_PIN, RELAY_PULSE_DURATION> CcRelay;
+typedef core::Output<LED_PIN> InfoLed;
+
+#endif